@@ -2,7 +2,7 @@
 
 # Check if a module name is provided
 if [ -z "$1" ]; then
-    echo "Usage: $0 <module_name> [build|clean]"
+    echo "Usage: $0 <module_name|all> [build|clean]"
     exit 1
 fi
 
@@ -18,36 +18,23 @@ KERNEL_DIR=$(pwd)/kernel  # Path to the full kernel source directory
 MODULE_DIR=$(pwd)/kernelModules  # Path to the custom module directory
 
 # Check if the module source file exists (only when building)
-if [ ! -f "$MODULE_DIR/$MODULE_NAME.c" ] && [ "$COMMAND" != "clean" ]; then
+if [ "$MODULE_NAME" != "all" ] && [ ! -f "$MODULE_DIR/$MODULE_NAME.c" ] && [ "$COMMAND" != "clean" ]; then
     echo "Error: Module source file $MODULE_DIR/$MODULE_NAME.c does not exist."
     exit 1
 fi
 
-# Create the Makefile dynamically
-echo "Creating Makefile for $MODULE_NAME..."
-
-cat <<EOL > $MODULE_DIR/Makefile
-# Name of the module
-obj-m += $MODULE_NAME.o
-
-# Path to the kernel headers or build directory
-KDIR := $KERNEL_DIR  # Use the full kernel source directory
-
-# Command to build the module
-all:
-	\$(MAKE) -C \$(KDIR) M=\$(PWD) modules
-
-# Command to clean the build files
-clean:
-	\$(MAKE) -C \$(KDIR) M=\$(PWD) clean
-EOL
+# kernelModules/Makefile and Kbuild are persistent, narrow the module list instead of rewriting them
+MAKE_ARGS="KDIR=$KERNEL_DIR ARCH=$ARCH CROSS_COMPILE=$CROSS_COMPILE"
+if [ "$MODULE_NAME" != "all" ]; then
+    MAKE_ARGS="$MAKE_ARGS MODULES=$MODULE_NAME"
+fi
 
 # Execute the build or clean command
 cd $MODULE_DIR
 
 if [ "$COMMAND" == "build" ]; then
     echo "Building the $MODULE_NAME module..."
-    make ARCH=$ARCH CROSS_COMPILE=$CROSS_COMPILE -j$(nproc)
+    make $MAKE_ARGS -j$(nproc)
 
     if [ $? -ne 0 ]; then
         echo "Module build failed!"
@@ -58,7 +45,7 @@ if [ "$COMMAND" == "build" ]; then
 
 elif [ "$COMMAND" == "clean" ]; then
     echo "Cleaning the $MODULE_NAME module..."
-    make ARCH=$ARCH CROSS_COMPILE=$CROSS_COMPILE clean
+    make $MAKE_ARGS clean
 
     if [ $? -ne 0 ]; then
         echo "Module clean failed!"
@@ -69,6 +56,6 @@ elif [ "$COMMAND" == "clean" ]; then
 
 else
     echo "Unknown command: $COMMAND"
-    echo "Usage: $0 <module_name> [build|clean]"
+    echo "Usage: $0 <module_name|all> [build|clean]"
     exit 1
 fi
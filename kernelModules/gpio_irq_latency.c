@@ -0,0 +1,252 @@
+/*
+ * gpio_irq_latency.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Description:
+ * Instrumented copy of the gpio_pb_led.c interrupt path for latency
+ * measurements. The hard IRQ handler does the same work (optionally
+ * toggling an LED line) and records CLOCK_MONOTONIC timestamps at handler
+ * entry, after the LED write and at handler exit. Samples are queued in a
+ * kfifo and read from /dev/elrpi4_gpio_irq_latency, where the reader adds
+ * its own userspace delivery timestamp.
+ *
+ * The button line is usually a gpio-sim line (see
+ * userapp/scripts/gpio_sim_setup.sh) or a physical loopback from another
+ * output pin:
+ *   insmod gpio_irq_latency.ko button_gpio=<global gpio nr> [led_gpio=<nr>]
+ * The IRQ number picked for the line is exported read-only in
+ * /sys/module/gpio_irq_latency/parameters/irq_number.
+ */
+
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/fs.h>
+#include <linux/cdev.h>
+#include <linux/gpio.h>
+#include <linux/interrupt.h>
+#include <linux/kfifo.h>
+#include <linux/poll.h>
+#include <linux/timekeeping.h>
+#include <linux/wait.h>
+#include "gpio_irq_latency.h"
+
+#define DRIVER_NAME  "elrpi4_gpio_irq_latency"
+#define DRIVER_CLASS "GPIO_IRQ_LATENCY"
+#define FIFO_SAMPLES 1024
+
+static int button_gpio = 17 + GPIO_DYNAMIC_BASE;
+module_param(button_gpio, int, 0444);
+MODULE_PARM_DESC(button_gpio, "Global GPIO number of the input line (default GPIO17)");
+
+static int led_gpio = -1;
+module_param(led_gpio, int, 0444);
+MODULE_PARM_DESC(led_gpio, "Global GPIO number of the LED line toggled by the handler, -1 for none");
+
+static bool both_edges;
+module_param(both_edges, bool, 0444);
+MODULE_PARM_DESC(both_edges, "Trigger on both edges instead of the rising edge only");
+
+static int irq_number = -1;
+module_param(irq_number, int, 0444);
+MODULE_PARM_DESC(irq_number, "IRQ mapped to button_gpio (read only)");
+
+static dev_t         sDevNo;
+static struct class *sDevClass;
+static struct cdev   sDevice;
+
+static DEFINE_KFIFO(samples, struct gpio_irq_latency_sample, FIFO_SAMPLES);
+static DEFINE_MUTEX(read_lock);
+static DECLARE_WAIT_QUEUE_HEAD(samples_wq);
+static u64 seq;
+static unsigned long dropped;
+static int led_state;
+
+static irqreturn_t gpio_irq_handler(int irq, void *dev_id)
+{
+	struct gpio_irq_latency_sample sample = {
+		.irq_entry_ns = ktime_get_ns(),
+	};
+
+	sample.seq = ++seq;
+
+	if (led_gpio >= 0) {
+		led_state = !led_state;
+		gpio_set_value(led_gpio, led_state);
+		sample.led_done_ns = ktime_get_ns();
+	}
+
+	sample.irq_exit_ns = ktime_get_ns();
+
+	/* Single producer (this handler), so kfifo_put() needs no lock */
+	if (!kfifo_put(&samples, sample))
+		dropped++;
+	wake_up_interruptible(&samples_wq);
+
+	return IRQ_HANDLED;
+}
+
+static ssize_t driver_read(struct file *File, char __user *user_buffer, size_t count, loff_t *offs)
+{
+	unsigned int copied;
+	int ret;
+
+	if (count < sizeof(struct gpio_irq_latency_sample))
+		return -EINVAL;
+
+	if (kfifo_is_empty(&samples)) {
+		if (File->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		ret = wait_event_interruptible(samples_wq, !kfifo_is_empty(&samples));
+		if (ret)
+			return ret;
+	}
+
+	/* kfifo_to_user() only copies whole samples */
+	if (mutex_lock_interruptible(&read_lock))
+		return -ERESTARTSYS;
+	ret = kfifo_to_user(&samples, user_buffer, count, &copied);
+	mutex_unlock(&read_lock);
+
+	return ret ? ret : copied;
+}
+
+static __poll_t driver_poll(struct file *File, poll_table *wait)
+{
+	poll_wait(File, &samples_wq, wait);
+	return kfifo_is_empty(&samples) ? 0 : EPOLLIN | EPOLLRDNORM;
+}
+
+/**
+ * @brief Every new reader starts with an empty queue
+ */
+static int driver_open(struct inode *device_file, struct file *instance)
+{
+	mutex_lock(&read_lock);
+	kfifo_reset_out(&samples);
+	mutex_unlock(&read_lock);
+	return 0;
+}
+
+static struct file_operations fops = {
+	.owner = THIS_MODULE,
+	.open = driver_open,
+	.read = driver_read,
+	.poll = driver_poll,
+};
+
+static int __init mod_init(void)
+{
+	int ret;
+
+	pr_info("%s(): button GPIO %d, LED GPIO %d\n", __func__, button_gpio, led_gpio);
+
+	if (!gpio_is_valid(button_gpio)) {
+		pr_err("%s(): Invalid button GPIO %d\n", __func__, button_gpio);
+		return -ENODEV;
+	}
+
+	ret = gpio_request(button_gpio, "IRQ_LATENCY_BUTTON");
+	if (ret) {
+		pr_err("%s(): Failed to request button GPIO %d\n", __func__, button_gpio);
+		return ret;
+	}
+	gpio_direction_input(button_gpio);
+
+	if (led_gpio >= 0) {
+		ret = gpio_request(led_gpio, "IRQ_LATENCY_LED");
+		if (ret) {
+			pr_err("%s(): Failed to request LED GPIO %d\n", __func__, led_gpio);
+			goto ButtonError;
+		}
+		/* The handler runs in hard IRQ context, a sleeping chip would splat */
+		if (gpio_cansleep(led_gpio)) {
+			pr_err("%s(): LED GPIO %d can sleep, pick a line on a non-sleeping chip\n",
+			       __func__, led_gpio);
+			ret = -EINVAL;
+			goto LedError;
+		}
+		gpio_direction_output(led_gpio, 0);
+	}
+
+	irq_number = gpio_to_irq(button_gpio);
+	if (irq_number < 0) {
+		pr_err("%s(): Failed to get IRQ for GPIO %d\n", __func__, button_gpio);
+		ret = irq_number;
+		goto LedError;
+	}
+
+	if (alloc_chrdev_region(&sDevNo, 0, 1, DRIVER_NAME) < 0) {
+		pr_err("%s(): Device Nr. could not be allocated!\n", __func__);
+		ret = -ENOMEM;
+		goto LedError;
+	}
+
+	sDevClass = class_create(DRIVER_CLASS);
+	if (IS_ERR(sDevClass)) {
+		pr_err("%s(): Device class can not be created!\n", __func__);
+		ret = PTR_ERR(sDevClass);
+		goto ClassError;
+	}
+
+	if (IS_ERR(device_create(sDevClass, NULL, sDevNo, NULL, DRIVER_NAME))) {
+		pr_err("%s(): Can not create device file!\n", __func__);
+		ret = -ENOMEM;
+		goto FileError;
+	}
+
+	cdev_init(&sDevice, &fops);
+	ret = cdev_add(&sDevice, sDevNo, 1);
+	if (ret) {
+		pr_err("%s(): Registering of device to kernel failed!\n", __func__);
+		goto AddError;
+	}
+
+	ret = request_irq(irq_number,
+			  gpio_irq_handler,
+			  both_edges ? IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING : IRQF_TRIGGER_RISING,
+			  "gpio_irq_latency",
+			  NULL);
+	if (ret) {
+		pr_err("%s(): Failed to request IRQ %d\n", __func__, irq_number);
+		goto IrqError;
+	}
+
+	pr_info("%s(): Button GPIO %d mapped to IRQ %d\n", __func__, button_gpio, irq_number);
+	return 0;
+IrqError:
+	cdev_del(&sDevice);
+AddError:
+	device_destroy(sDevClass, sDevNo);
+FileError:
+	class_destroy(sDevClass);
+ClassError:
+	unregister_chrdev_region(sDevNo, 1);
+LedError:
+	if (led_gpio >= 0)
+		gpio_free(led_gpio);
+ButtonError:
+	gpio_free(button_gpio);
+	return ret;
+}
+
+static void __exit mod_exit(void)
+{
+	free_irq(irq_number, NULL);
+	cdev_del(&sDevice);
+	device_destroy(sDevClass, sDevNo);
+	class_destroy(sDevClass);
+	unregister_chrdev_region(sDevNo, 1);
+	if (led_gpio >= 0) {
+		gpio_set_value(led_gpio, 0);
+		gpio_free(led_gpio);
+	}
+	gpio_free(button_gpio);
+	pr_info("%s(): %llu interrupts, %lu samples dropped\n", __func__, seq, dropped);
+}
+
+module_init(mod_init);
+module_exit(mod_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("ravi");
+MODULE_DESCRIPTION("GPIO IRQ latency instrumentation for the push button/LED path");
@@ -0,0 +1,25 @@
+/*
+ * gpio_irq_latency.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Sample format shared between gpio_irq_latency.c and the userspace
+ * benchmark (userapp/bench/gpio_irq_latency.c). All timestamps are
+ * CLOCK_MONOTONIC nanoseconds, so they compare directly with
+ * clock_gettime(CLOCK_MONOTONIC) in userspace.
+ */
+
+#ifndef GPIO_IRQ_LATENCY_H
+#define GPIO_IRQ_LATENCY_H
+
+#include <linux/types.h>
+
+#define GPIO_IRQ_LATENCY_DEV "/dev/elrpi4_gpio_irq_latency"
+
+struct gpio_irq_latency_sample {
+	__u64 seq;          /* 1-based count of handled interrupts */
+	__u64 irq_entry_ns; /* first thing in the hard IRQ handler */
+	__u64 led_done_ns;  /* after gpio_set_value() on the LED, 0 without LED */
+	__u64 irq_exit_ns;  /* right before the handler returns */
+};
+
+#endif /* GPIO_IRQ_LATENCY_H */
@@ -2,6 +2,16 @@
  * gpio_led.c
  * author: Venkata Naga Ravikiran Bulusu
  *
+ * Description:
+ * Red LED on GPIO15. Besides the '0'/'1' chardev the LED is registered
+ * with the LED class as /sys/class/leds/elrpi4:red:status, so any kernel
+ * trigger (heartbeat, disk-activity, netdev, cpu, timer, ...) can drive it
+ * without a userspace daemon:
+ *   insmod gpio_led.ko default_trigger=heartbeat
+ *   echo netdev > /sys/class/leds/elrpi4:red:status/trigger
+ * GPIO has no blink hardware; blink_set is a software blink on an hrtimer,
+ * which gives the timer trigger and led_blink_set() users exact on/off
+ * periods instead of the jiffy granular blink timer of the LED core.
  */
 
 #include <linux/module.h>
@@ -10,6 +20,9 @@
 #include <linux/cdev.h>
 #include <linux/uaccess.h>
 #include <linux/gpio.h>
+#include <linux/hrtimer.h>
+#include <linux/leds.h>
+#include <linux/version.h>
 
 /* Variables for device and device class */
 static dev_t         sDevNo;
@@ -19,6 +32,63 @@ static struct cdev   sDevice;
 #define DRIVER_NAME "elrpi4_led_gpio_driver"
 #define DRIVER_CLASS "LED_BUTTON"
 #define RED_GPIO_LED 15 + GPIO_DYNAMIC_BASE // 15 + 512           /* GPIO15 with a base of gpiochip0 on 512 */
+#define LED_NAME "elrpi4:red:status"
+#define BLINK_DEFAULT_MS 500
+
+static char *default_trigger;
+module_param(default_trigger, charp, 0444);
+MODULE_PARM_DESC(default_trigger, "LED trigger to attach at load time, e.g. heartbeat");
+
+static struct hrtimer sBlinkTimer;
+static unsigned long  sDelayOn, sDelayOff;
+static int            sBlinkState;
+
+/**
+ * @brief Toggle the LED and re-arm for the next half period
+ */
+static enum hrtimer_restart led_blink_timer(struct hrtimer *timer) {
+	sBlinkState = !sBlinkState;
+	gpio_set_value(RED_GPIO_LED, sBlinkState);
+	hrtimer_forward_now(timer, ms_to_ktime(sBlinkState ? sDelayOn : sDelayOff));
+	return HRTIMER_RESTART;
+}
+
+/**
+ * @brief LED class brightness callback, a fixed brightness ends any blinking
+ */
+static void gpio_led_brightness_set(struct led_classdev *led, enum led_brightness value) {
+	hrtimer_cancel(&sBlinkTimer);
+	gpio_set_value(RED_GPIO_LED, value != LED_OFF);
+}
+
+/**
+ * @brief LED class blink callback, software blink on sBlinkTimer
+ */
+static int gpio_led_blink_set(struct led_classdev *led, unsigned long *delay_on, unsigned long *delay_off) {
+	if(!*delay_on && !*delay_off) {
+		*delay_on = BLINK_DEFAULT_MS;
+		*delay_off = BLINK_DEFAULT_MS;
+	}
+
+	hrtimer_cancel(&sBlinkTimer);
+	sDelayOn = *delay_on;
+	sDelayOff = *delay_off;
+
+	/* A zero phase means the LED just stays in the other state */
+	sBlinkState = sDelayOn != 0;
+	gpio_set_value(RED_GPIO_LED, sBlinkState);
+	if(sDelayOn && sDelayOff) {
+		hrtimer_start(&sBlinkTimer, ms_to_ktime(sDelayOn), HRTIMER_MODE_REL);
+	}
+	return 0;
+}
+
+static struct led_classdev sLed = {
+	.name           = LED_NAME,
+	.max_brightness = 1,
+	.brightness_set = gpio_led_brightness_set,
+	.blink_set      = gpio_led_blink_set,
+};
 
 static ssize_t driver_read(struct file *File, char *user_buffer, size_t count, loff_t *offs) {
     printk("empty read!\n");
@@ -38,13 +108,15 @@ static ssize_t driver_write(struct file *File, const char *user_buffer, size_t c
 	/* Copy data to user */
 	not_copied = copy_from_user(&value, user_buffer, to_copy);
 
-	/* Setting the LED */
+	/* Setting the LED, the chardev takes it over from any active trigger */
 	switch(value) {
 		case '0':
-			gpio_set_value(RED_GPIO_LED, 0);
+			led_trigger_remove(&sLed);
+			led_set_brightness(&sLed, LED_OFF);
 			break;
 		case '1':
-			gpio_set_value(RED_GPIO_LED, 1);
+			led_trigger_remove(&sLed);
+			led_set_brightness(&sLed, LED_FULL);
 			break;
 		default:
 			printk("Invalid Input!\n");
@@ -85,6 +157,15 @@ static struct file_operations fops = {
  * @brief This function is called, when the module is loaded into the kernel
  */
 static int __init ModuleInit(void) {
+	struct device *dev;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+	hrtimer_setup(&sBlinkTimer, led_blink_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+#else
+	hrtimer_init(&sBlinkTimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	sBlinkTimer.function = led_blink_timer;
+#endif
+
 	/* Allocate a device nr */
 	if( alloc_chrdev_region(&sDevNo, 0, 1, DRIVER_NAME) < 0) {
 		printk("Device Nr. could not be allocated!\n");
@@ -93,13 +174,15 @@ static int __init ModuleInit(void) {
 	printk("read_write - Device Nr. Major: %d, Minor: %d was registered!\n", sDevNo >> 20, sDevNo & 0xfffff);
 
 	/* Create device class */
-	if((sDevClass = class_create(DRIVER_CLASS)) == NULL) {
+	sDevClass = class_create(DRIVER_CLASS);
+	if(IS_ERR(sDevClass)) {
 		printk("Device class can not be created!\n");
 		goto ClassError;
 	}
 
 	/* create device file */
-	if(device_create(sDevClass, NULL, sDevNo, NULL, DRIVER_NAME) == NULL) {
+	dev = device_create(sDevClass, NULL, sDevNo, NULL, DRIVER_NAME);
+	if(IS_ERR(dev)) {
 		printk("Can not create device file!\n");
 		goto FileError;
 	}
@@ -116,7 +199,7 @@ static int __init ModuleInit(void) {
 	/* GPIO 15 init */
 	if(gpio_request(RED_GPIO_LED, "rpi-gpio-15")) {
 		printk("Can not allocate GPIO 15\n");
-		goto AddError;
+		goto CdevError;
 	}
 
 	/* Set GPIO 15 direction */
@@ -124,10 +207,25 @@ static int __init ModuleInit(void) {
 		printk("Can not set GPIO 15 to output!\n");
 		goto Gpio15Error;
 	}
-    
+
+	/* The hrtimer callback and triggers call in atomic context */
+	if(gpio_cansleep(RED_GPIO_LED)) {
+		printk("GPIO 15 sleeps, can not be driven by LED triggers\n");
+		goto Gpio15Error;
+	}
+
+	/* Register with the LED class, the chardev device is the parent */
+	sLed.default_trigger = default_trigger;
+	if(led_classdev_register(dev, &sLed)) {
+		printk("Can not register LED class device!\n");
+		goto Gpio15Error;
+	}
+
 	return 0;
 Gpio15Error:
 	gpio_free(RED_GPIO_LED);
+CdevError:
+	cdev_del(&sDevice);
 AddError:
 	device_destroy(sDevClass, sDevNo);
 FileError:
@@ -141,6 +239,8 @@ ClassError:
  * @brief This function is called, when the module is removed from the kernel
  */
 static void __exit ModuleExit(void) {
+	led_classdev_unregister(&sLed);
+	hrtimer_cancel(&sBlinkTimer);
 	gpio_set_value(RED_GPIO_LED, 0);
 	gpio_free(RED_GPIO_LED);
 	cdev_del(&sDevice);
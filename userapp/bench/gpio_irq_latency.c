@@ -0,0 +1,400 @@
+/*
+ * gpio_irq_latency.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Description:
+ * End-to-end latency benchmark for the GPIO interrupt path. Drives edges
+ * into the line watched by kernelModules/gpio_irq_latency.ko, either
+ * through a gpio-sim "pull" attribute or through a physical loopback from
+ * an output pin, and combines the userspace edge/delivery timestamps with
+ * the IRQ-entry, LED-toggle and handler-exit timestamps from the module.
+ * Prints min/avg/percentiles and a log2 histogram for every stage,
+ * optionally under CPU stress and with a chosen IRQ affinity.
+ *
+ * gpio-sim:  scripts/gpio_sim_setup.sh setup
+ *            insmod gpio_irq_latency.ko button_gpio=<base>
+ *            ./gpio_irq_latency -s /sys/devices/platform/gpio-sim.0/gpiochipN/sim_gpio0/pull
+ * loopback:  wire GPIO 27 to GPIO 17, insmod gpio_irq_latency.ko
+ *            ./gpio_irq_latency -g gpiomem -o 27
+ *
+ * For isolcpus runs boot with isolcpus=<cpu>, then pin the benchmark (-c)
+ * and the IRQ (-a) to the isolated CPU.
+ *
+ * build: make bench/gpio_irq_latency
+ */
+
+#define _GNU_SOURCE // sched_setaffinity()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include "../gpio_backend.h"
+#include "../rt_util.h"
+#include "../../kernelModules/gpio_irq_latency.h"
+
+#define IRQ_PARAM_PATH   "/sys/module/gpio_irq_latency/parameters/irq_number"
+#define ISOLATED_PATH    "/sys/devices/system/cpu/isolated"
+#define HIST_MIN_NS      64        // upper bound of the first bucket, handler stages run in ns
+#define HIST_BUCKETS     28        // log2 buckets from 64 ns up to ~8 s
+#define WAIT_TIMEOUT_MS  1000
+#define MAX_STRESS       64
+
+enum stage {
+    STAGE_EDGE_TO_IRQ,
+    STAGE_IRQ_TO_LED,
+    STAGE_HANDLER,
+    STAGE_EXIT_TO_USER,
+    STAGE_EDGE_TO_USER,
+    STAGE_COUNT,
+};
+
+static const char *stage_names[STAGE_COUNT] = {
+    "edge -> IRQ entry",
+    "IRQ entry -> LED toggled",
+    "IRQ entry -> handler exit",
+    "handler exit -> userspace",
+    "edge -> userspace",
+};
+
+struct stage_stats {
+    int64_t *ns;
+    size_t count;
+};
+
+// Where the edges come from: a gpio-sim pull attribute or a real output line
+struct edge_source {
+    int sim_fd;
+    struct gpio_dev gpio;
+    unsigned int line;
+};
+
+static struct stage_stats stats[STAGE_COUNT];
+static pid_t stress_pids[MAX_STRESS];
+static int stress_count;
+
+static int drive_edge(struct edge_source *src, int level) {
+    if (src->sim_fd >= 0) {
+        const char *pull = level ? "pull-up" : "pull-down";
+        if (pwrite(src->sim_fd, pull, strlen(pull), 0) < 0) {
+            perror("Failed to write gpio-sim pull");
+            return -1;
+        }
+        return 0;
+    }
+    return gpio_set(&src->gpio, src->line, level);
+}
+
+static void record(enum stage stage, int64_t ns) {
+    stats[stage].ns[stats[stage].count++] = ns;
+}
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report_stage(enum stage stage) {
+    struct stage_stats *s = &stats[stage];
+    size_t hist[HIST_BUCKETS] = { 0 };
+    size_t peak = 0;
+    int64_t sum = 0;
+
+    if (!s->count) {
+        return;
+    }
+    qsort(s->ns, s->count, sizeof(s->ns[0]), cmp_i64);
+    for (size_t i = 0; i < s->count; i++) {
+        int bucket = 0;
+
+        sum += s->ns[i];
+        while (bucket < HIST_BUCKETS - 1 && s->ns[i] >= (HIST_MIN_NS << bucket)) {
+            bucket++;
+        }
+        if (++hist[bucket] > peak) {
+            peak = hist[bucket];
+        }
+    }
+
+    printf("\n%s (%zu samples, us)\n", stage_names[stage], s->count);
+    printf("  min %.2f  avg %.2f  p50 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+           s->ns[0] / 1000.0, (double)sum / s->count / 1000.0,
+           s->ns[s->count / 2] / 1000.0, s->ns[s->count * 99 / 100] / 1000.0,
+           s->ns[s->count * 999 / 1000] / 1000.0, s->ns[s->count - 1] / 1000.0);
+
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        if (!hist[b]) {
+            continue;
+        }
+        int bar = (int)(hist[b] * 50 / peak);
+        printf("  < %12.3f us %8zu ", (HIST_MIN_NS << b) / 1000.0, hist[b]);
+        for (int i = 0; i < bar; i++) {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+static int read_irq_number(void) {
+    FILE *f = fopen(IRQ_PARAM_PATH, "r");
+    int irq = -1;
+
+    if (!f || fscanf(f, "%d", &irq) != 1) {
+        fprintf(stderr, "Could not read %s, is gpio_irq_latency.ko loaded?\n", IRQ_PARAM_PATH);
+    }
+    if (f) {
+        fclose(f);
+    }
+    return irq;
+}
+
+static int set_irq_affinity(int irq, const char *cpus) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/irq/%d/smp_affinity_list", irq);
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("Failed to open IRQ affinity");
+        return -1;
+    }
+    fprintf(f, "%s\n", cpus);
+    if (fclose(f) != 0) {
+        perror("Failed to set IRQ affinity");
+        return -1;
+    }
+    return 0;
+}
+
+static void print_isolated_cpus(void) {
+    char line[128] = "";
+    FILE *f = fopen(ISOLATED_PATH, "r");
+
+    if (f) {
+        if (!fgets(line, sizeof(line), f)) {
+            line[0] = '\0';
+        }
+        fclose(f);
+    }
+    line[strcspn(line, "\n")] = '\0';
+    printf("isolated CPUs: %s\n", line[0] ? line : "none");
+}
+
+/*
+ * Plain busy loops are enough to keep every other CPU out of idle states.
+ * Called before the benchmark pins itself and goes SCHED_FIFO, so the
+ * workers stay SCHED_OTHER and spread over all CPUs except the measuring one.
+ */
+static void start_stress(int workers, int cpu) {
+    pid_t parent = getpid();
+
+    for (int i = 0; i < workers && i < MAX_STRESS; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            volatile unsigned long spin = 0;
+            cpu_set_t set;
+
+            // Die with the benchmark, however it exits; the getppid() check
+            // covers a parent that died before the signal was armed
+            if (prctl(PR_SET_PDEATHSIG, SIGKILL) < 0 || getppid() != parent) {
+                _exit(EXIT_FAILURE);
+            }
+            if (cpu >= 0 && sched_getaffinity(0, sizeof(set), &set) == 0) {
+                CPU_CLR(cpu, &set);
+                if (CPU_COUNT(&set) > 0) {
+                    sched_setaffinity(0, sizeof(set), &set);
+                }
+            }
+            for (;;) {
+                spin++;
+            }
+        }
+        if (pid > 0) {
+            stress_pids[stress_count++] = pid;
+        }
+    }
+}
+
+static void stop_stress(void) {
+    for (int i = 0; i < stress_count; i++) {
+        kill(stress_pids[i], SIGKILL);
+        waitpid(stress_pids[i], NULL, 0);
+    }
+}
+
+static void sleep_until(int64_t deadline_ns) {
+    struct timespec ts = { deadline_ns / 1000000000LL, deadline_ns % 1000000000LL };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// Throw away samples from falling edges (module loaded with both_edges=1)
+static void drain_samples(int fd) {
+    struct gpio_irq_latency_sample sample;
+    while (read(fd, &sample, sizeof(sample)) == sizeof(sample)) {
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s (-s sim_pull_path | -o line [-g gpio_spec]) [options]\n"
+                    "  -s  gpio-sim pull attribute of the input line\n"
+                    "  -o  output line wired to the input line (physical loopback)\n"
+                    "  -g  GPIO backend for -o (default gpiochip0, see gpio_backend.h)\n"
+                    "  -n  number of edges (default 1000)\n"
+                    "  -i  interval between edges in us (default 1000)\n"
+                    "  -c  pin the benchmark to this CPU\n"
+                    "  -p  run with SCHED_FIFO at this priority\n"
+                    "  -S  number of CPU stress workers\n"
+                    "  -a  IRQ affinity list, e.g. \"3\"\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    struct edge_source src = { .sim_fd = -1 };
+    const char *sim_path = NULL;
+    const char *gpio_spec = "gpiochip0";
+    const char *irq_cpus = NULL;
+    int out_line = -1;
+    long count = 1000;
+    long interval_us = 1000;
+    int cpu = -1;
+    int prio = 0;
+    int workers = 0;
+    long missed = 0;
+    int ret = EXIT_FAILURE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:o:g:n:i:c:p:S:a:h")) != -1) {
+        switch (opt) {
+        case 's': sim_path = optarg; break;
+        case 'o': out_line = atoi(optarg); break;
+        case 'g': gpio_spec = optarg; break;
+        case 'n': count = atol(optarg); break;
+        case 'i': interval_us = atol(optarg); break;
+        case 'c': cpu = atoi(optarg); break;
+        case 'p': prio = atoi(optarg); break;
+        case 'S': workers = atoi(optarg); break;
+        case 'a': irq_cpus = optarg; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((!sim_path) == (out_line < 0) || count <= 0 || interval_us <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        stats[s].ns = calloc((size_t)count, sizeof(int64_t));
+        if (!stats[s].ns) {
+            perror("calloc");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Edge source
+    if (sim_path) {
+        src.sim_fd = open(sim_path, O_WRONLY | O_CLOEXEC);
+        if (src.sim_fd < 0) {
+            perror("Failed to open gpio-sim pull attribute");
+            return EXIT_FAILURE;
+        }
+    } else {
+        src.line = (unsigned int)out_line;
+        if (gpio_open(&src.gpio, gpio_spec) < 0 ||
+            gpio_request_output(&src.gpio, src.line, 0, "gpio_irq_latency") < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    int dev_fd = open(GPIO_IRQ_LATENCY_DEV, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (dev_fd < 0) {
+        perror("Failed to open " GPIO_IRQ_LATENCY_DEV);
+        goto SourceError;
+    }
+
+    // Environment
+    int irq = read_irq_number();
+    printf("IRQ %d, %ld edges every %ld us, %d stress workers\n", irq, count, interval_us, workers);
+    print_isolated_cpus();
+    if (irq_cpus && irq >= 0 && set_irq_affinity(irq, irq_cpus) == 0) {
+        printf("IRQ affinity: %s\n", irq_cpus);
+    }
+    start_stress(workers, cpu);
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+            perror("sched_setaffinity");
+        }
+    }
+    if (prio > 0) {
+        make_realtime(prio);
+    }
+
+    // Measurement loop: low, wait half a period, rising edge, wait for the sample
+    int64_t next = now_ns();
+    for (long i = 0; i < count; i++) {
+        struct gpio_irq_latency_sample sample;
+        struct pollfd pfd = { .fd = dev_fd, .events = POLLIN };
+
+        drive_edge(&src, 0);
+        next += interval_us * 500;
+        sleep_until(next);
+        drain_samples(dev_fd);
+
+        next += interval_us * 500;
+        sleep_until(next);
+
+        // With gpio-sim this includes the sysfs write that raises the line
+        int64_t t_edge = now_ns();
+        if (drive_edge(&src, 1) < 0) {
+            break;
+        }
+        if (poll(&pfd, 1, WAIT_TIMEOUT_MS) <= 0 ||
+            read(dev_fd, &sample, sizeof(sample)) != sizeof(sample)) {
+            missed++;
+            continue;
+        }
+        int64_t t_user = now_ns();
+
+        record(STAGE_EDGE_TO_IRQ, (int64_t)sample.irq_entry_ns - t_edge);
+        if (sample.led_done_ns) {
+            record(STAGE_IRQ_TO_LED, (int64_t)(sample.led_done_ns - sample.irq_entry_ns));
+        }
+        record(STAGE_HANDLER, (int64_t)(sample.irq_exit_ns - sample.irq_entry_ns));
+        record(STAGE_EXIT_TO_USER, t_user - (int64_t)sample.irq_exit_ns);
+        record(STAGE_EDGE_TO_USER, t_user - t_edge);
+    }
+    drive_edge(&src, 0);
+    stop_stress();
+
+    if (missed) {
+        printf("%ld edges produced no sample within %d ms\n", missed, WAIT_TIMEOUT_MS);
+    }
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        report_stage(s);
+    }
+    ret = EXIT_SUCCESS;
+
+    close(dev_fd);
+SourceError:
+    if (src.sim_fd >= 0) {
+        close(src.sim_fd);
+    } else {
+        gpio_close(&src.gpio);
+    }
+    return ret;
+}
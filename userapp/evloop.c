@@ -0,0 +1,103 @@
+/*
+ * evloop.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Single-threaded epoll loop shared by the daemons, see evloop.h.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "evloop.h"
+
+#define MAX_EVENTS 16
+
+static int epfd = -1;
+static int running;
+
+int evloop_init(void) {
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+    return 0;
+}
+
+void evloop_close(void) {
+    close(epfd);
+    epfd = -1;
+}
+
+int add_source(struct source *src, int fd, source_handler handler) {
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = src };
+
+    src->fd = fd;
+    src->handler = handler;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl");
+        return -1;
+    }
+    return 0;
+}
+
+void remove_source(struct source *src) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, src->fd, NULL);
+    close(src->fd);
+    src->fd = -1;
+}
+
+int evloop_run(void) {
+    running = 1;
+    while (running) {
+        struct epoll_event events[MAX_EVENTS];
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            struct source *src = events[i].data.ptr;
+            if (src->fd >= 0) { // may have been closed earlier in this batch
+                src->handler(src, events[i].events);
+            }
+        }
+    }
+    return 0;
+}
+
+void evloop_stop(void) {
+    running = 0;
+}
+
+int open_control_socket(const char *path, int backlog) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, backlog) < 0) {
+        perror("Failed to bind control socket");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
@@ -0,0 +1,39 @@
+/*
+ * evloop.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Single-threaded epoll loop used by gpio_eventd and ssd1306_server. Every
+ * fd is registered together with a struct source, usually embedded in a
+ * bigger per-fd struct, whose handler runs when the fd becomes readable.
+ */
+
+#ifndef EVLOOP_H
+#define EVLOOP_H
+
+#include <stdint.h>
+
+struct source;
+typedef void (*source_handler)(struct source *src, uint32_t events);
+
+// Every fd registered with epoll carries one of these as its user data
+struct source {
+    int fd;
+    source_handler handler;
+};
+
+int  evloop_init(void);
+void evloop_close(void);
+
+// Register fd (which may be -1 from a failed open, reported as an error)
+int  add_source(struct source *src, int fd, source_handler handler);
+// Unregister and close, src->fd is -1 afterwards
+void remove_source(struct source *src);
+
+// Run handlers until evloop_stop() is called, returns -1 if epoll_wait failed
+int  evloop_run(void);
+void evloop_stop(void);
+
+// Non-blocking listening unix stream socket at path, replacing a stale one
+int  open_control_socket(const char *path, int backlog);
+
+#endif // EVLOOP_H
@@ -0,0 +1,18 @@
+/*
+ * font5x8.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ */
+
+#ifndef FONT5X8_H
+#define FONT5X8_H
+
+#include <stdint.h>
+
+#define FONT5X8_FIRST  ' '
+#define FONT5X8_COUNT  95
+#define FONT5X8_WIDTH  5
+
+extern const uint8_t font5x8[FONT5X8_COUNT][FONT5X8_WIDTH];
+
+#endif // FONT5X8_H
@@ -0,0 +1,73 @@
+/*
+ * font_atlas.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Pre-rendered glyph atlases generated at build time by
+ * tools/gen_font_atlas.c from the 5x8 base font (see font_atlas.c rule in
+ * the Makefile). Glyph data is stored in SSD1306 page-major layout:
+ * height_pages rows of width[i] column bytes, so drawing a glyph at a page
+ * aligned position is one memcpy per page with no runtime scaling or
+ * rotation.
+ */
+
+#ifndef FONT_ATLAS_H
+#define FONT_ATLAS_H
+
+#include <stdint.h>
+
+enum font_rotation {
+    FONT_ROT_0,
+    FONT_ROT_90,  // rotated clockwise, text runs top to bottom
+    FONT_ROT_180, // upside down, text runs right to left on the panel
+};
+
+struct font_atlas {
+    uint8_t first;              // first encoded character
+    uint8_t count;              // number of glyphs
+    uint8_t height_pages;       // glyph height in 8-pixel pages
+    uint8_t spacing;            // blank columns (or pages for FONT_ROT_90) between glyphs
+    uint8_t rotation;           // enum font_rotation
+    const uint8_t *width;       // per glyph width in columns
+    const uint16_t *offset;     // per glyph offset into data
+    const uint8_t *data;        // glyph bitmaps, page-major
+    const int8_t *kerning;      // count x count column adjustments, NULL if none
+};
+
+static inline const uint8_t *font_glyph(const struct font_atlas *font, char ch, uint8_t *width) {
+    unsigned int idx = (unsigned char)ch - font->first;
+
+    if (idx >= font->count) {
+        idx = ' ' - font->first; // Default to space if character out of range
+    }
+    *width = font->width[idx];
+    return font->data + font->offset[idx];
+}
+
+static inline int font_kerning(const struct font_atlas *font, char left, char right) {
+    unsigned int l = (unsigned char)left - font->first;
+    unsigned int r = (unsigned char)right - font->first;
+
+    if (!font->kerning || l >= font->count || r >= font->count) {
+        return 0;
+    }
+    return font->kerning[l * font->count + r];
+}
+
+// Drawing area inside a framebuffer, in columns and pages, end exclusive
+struct font_clip {
+    int x0, x1;
+    int page0, page1;
+};
+
+int font_draw_text(uint8_t *fb, unsigned int stride, const struct font_clip *clip, uint32_t *dirty,
+                   const struct font_atlas *font, int x, int page, const char *str);
+
+extern const struct font_atlas font_5x8;         // 1x, monospaced
+extern const struct font_atlas font_10x16;       // 2x, monospaced
+extern const struct font_atlas font_15x24;       // 3x, monospaced
+extern const struct font_atlas font_5x8_rot90;
+extern const struct font_atlas font_5x8_rot180;
+extern const struct font_atlas font_5x8_prop;    // 1x, proportional with kerning
+extern const struct font_atlas font_10x16_prop;  // 2x, proportional with kerning
+
+#endif // FONT_ATLAS_H
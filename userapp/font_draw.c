@@ -0,0 +1,56 @@
+/*
+ * font_draw.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Text rendering with the generated atlases into any page-major
+ * framebuffer (the panel driver and the display server clients).
+ */
+
+#include <string.h>
+#include "font_atlas.h"
+
+// Copy one pre-rendered glyph into the framebuffer, clipped to the drawing area
+static void font_blit(uint8_t *fb, unsigned int stride, const struct font_clip *clip, uint32_t *dirty,
+                      const uint8_t *glyph, uint8_t width, uint8_t pages, int x, int page) {
+    int first = x < clip->x0 ? clip->x0 - x : 0;
+    int last = x + width > clip->x1 ? clip->x1 - x : width;
+
+    if (first >= last) {
+        return;
+    }
+    for (int p = 0; p < pages; p++, glyph += width) {
+        if (page + p < clip->page0 || page + p >= clip->page1) {
+            continue;
+        }
+        memcpy(fb + (size_t)(page + p) * stride + x + first, glyph + first, (size_t)(last - first));
+        *dirty |= 1u << (page + p);
+    }
+}
+
+/*
+ * Returns the cursor after the text: the next column for
+ * FONT_ROT_0/FONT_ROT_180, the next page for FONT_ROT_90. Pages that were
+ * written are ORed into *dirty.
+ */
+int font_draw_text(uint8_t *fb, unsigned int stride, const struct font_clip *clip, uint32_t *dirty,
+                   const struct font_atlas *font, int x, int page, const char *str) {
+    size_t len = strlen(str);
+    uint8_t width;
+
+    for (size_t i = 0; i < len; i++) {
+        // Upside-down text is laid out right to left so it reads correctly on a flipped panel
+        char ch = font->rotation == FONT_ROT_180 ? str[len - 1 - i] : str[i];
+        const uint8_t *glyph = font_glyph(font, ch, &width);
+
+        font_blit(fb, stride, clip, dirty, glyph, width, font->height_pages, x, page);
+        if (font->rotation == FONT_ROT_90) {
+            page += font->height_pages + font->spacing;
+        } else {
+            x += width + font->spacing;
+            if (i + 1 < len) {
+                x += font_kerning(font, ch, str[i + 1]);
+            }
+        }
+    }
+    return font->rotation == FONT_ROT_90 ? page : x;
+}
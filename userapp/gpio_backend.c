@@ -0,0 +1,172 @@
+/*
+ * gpio_backend.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "gpio_backend.h"
+
+#define GPIO_SPEC_GPIOMEM "gpiomem"
+
+static int gpiomem_open(struct gpio_dev *dev, const char *path) {
+    int flags = O_RDWR | O_SYNC | O_CLOEXEC;
+
+    if (dev->emulated) {
+        flags |= O_CREAT;
+    }
+
+    dev->mem_fd = open(path, flags, 0644);
+    if (dev->mem_fd < 0) {
+        perror("Failed to open GPIO memory");
+        return -1;
+    }
+
+    // A fresh emulated register file starts out as an all-zero block
+    if (dev->emulated && ftruncate(dev->mem_fd, GPIO_MAP_SIZE) < 0) {
+        perror("Failed to size emulated GPIO register file");
+        close(dev->mem_fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, GPIO_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, dev->mem_fd, 0);
+    if (map == MAP_FAILED) {
+        perror("Failed to map GPIO registers");
+        close(dev->mem_fd);
+        return -1;
+    }
+    dev->regs = map;
+    return 0;
+}
+
+int gpio_open(struct gpio_dev *dev, const char *spec) {
+    size_t prefix = strlen(GPIO_SPEC_GPIOMEM);
+
+    memset(dev, 0, sizeof(*dev));
+    dev->mem_fd = -1;
+
+    if (!strncmp(spec, GPIO_SPEC_GPIOMEM, prefix) && (spec[prefix] == '\0' || spec[prefix] == ':')) {
+        dev->type = GPIO_BACKEND_GPIOMEM;
+        dev->emulated = spec[prefix] == ':';
+        return gpiomem_open(dev, dev->emulated ? spec + prefix + 1 : GPIO_DEV_GPIOMEM);
+    }
+
+    dev->type = GPIO_BACKEND_GPIOD;
+#ifndef GPIO_NO_GPIOD
+    dev->chip = gpiod_chip_open_by_name(spec);
+    if (!dev->chip) {
+        perror("Failed to open GPIO chip");
+        return -1;
+    }
+    return 0;
+#else
+    fprintf(stderr, "Built without libgpiod, \"%s\" is not available (use gpiomem)\n", spec);
+    return -1;
+#endif
+}
+
+void gpio_close(struct gpio_dev *dev) {
+    if (dev->type == GPIO_BACKEND_GPIOMEM) {
+        munmap((void *)dev->regs, GPIO_MAP_SIZE);
+        close(dev->mem_fd);
+    } else {
+#ifndef GPIO_NO_GPIOD
+        // Closing the chip also releases every requested line
+        gpiod_chip_close(dev->chip);
+#endif
+    }
+}
+
+// Function select is a read-modify-write, only call it during setup
+static void gpiomem_set_function(struct gpio_dev *dev, unsigned int line, uint32_t function) {
+    volatile uint32_t *fsel = &dev->regs[GPIO_REG_GPFSEL0 + line / 10];
+    unsigned int shift = (line % 10) * 3;
+
+    *fsel = (*fsel & ~(7u << shift)) | (function << shift);
+}
+
+#ifndef GPIO_NO_GPIOD
+static struct gpiod_line *gpiod_get(struct gpio_dev *dev, unsigned int line) {
+    if (!dev->lines[line]) {
+        dev->lines[line] = gpiod_chip_get_line(dev->chip, line);
+        if (!dev->lines[line]) {
+            perror("Failed to get GPIO line");
+        }
+    }
+    return dev->lines[line];
+}
+#endif
+
+int gpio_request_output(struct gpio_dev *dev, unsigned int line, int value, const char *consumer) {
+    if (line >= GPIO_MAX_LINES) {
+        fprintf(stderr, "Invalid GPIO line %u\n", line);
+        return -1;
+    }
+
+    if (dev->type == GPIO_BACKEND_GPIOMEM) {
+        // Latch the level first so the pin does not glitch when it becomes an output
+        gpio_set(dev, line, value);
+        gpiomem_set_function(dev, line, 1);
+        return 0;
+    }
+
+#ifndef GPIO_NO_GPIOD
+    struct gpiod_line *l = gpiod_get(dev, line);
+    if (!l || gpiod_line_request_output(l, consumer, value) < 0) {
+        perror("Failed to request GPIO line as output");
+        return -1;
+    }
+    return 0;
+#else
+    (void)consumer;
+    return -1;
+#endif
+}
+
+int gpio_request_input(struct gpio_dev *dev, unsigned int line, const char *consumer) {
+    if (line >= GPIO_MAX_LINES) {
+        fprintf(stderr, "Invalid GPIO line %u\n", line);
+        return -1;
+    }
+
+    if (dev->type == GPIO_BACKEND_GPIOMEM) {
+        gpiomem_set_function(dev, line, 0);
+        return 0;
+    }
+
+#ifndef GPIO_NO_GPIOD
+    struct gpiod_line *l = gpiod_get(dev, line);
+    if (!l || gpiod_line_request_input(l, consumer) < 0) {
+        perror("Failed to request GPIO line as input");
+        return -1;
+    }
+    return 0;
+#else
+    (void)consumer;
+    return -1;
+#endif
+}
+
+int gpio_get(struct gpio_dev *dev, unsigned int line) {
+    if (line >= GPIO_MAX_LINES) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (dev->type == GPIO_BACKEND_GPIOMEM) {
+        return (dev->regs[GPIO_REG_GPLEV0 + (line >> 5)] >> (line & 31)) & 1;
+    }
+#ifndef GPIO_NO_GPIOD
+    if (!dev->lines[line]) { // never requested
+        errno = EINVAL;
+        return -1;
+    }
+    return gpiod_line_get_value(dev->lines[line]);
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
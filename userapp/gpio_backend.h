@@ -0,0 +1,102 @@
+/*
+ * gpio_backend.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Output/input GPIO access with two interchangeable backends:
+ *   - libgpiod: character device ioctls, works on any gpiochip
+ *   - gpiomem:  BCM2711 GPIO registers mapped from /dev/gpiomem, a line
+ *               change is a single store to GPSETn/GPCLRn
+ *
+ * The backend is picked by the spec string passed to gpio_open():
+ *   "gpiochip0"          libgpiod on the named chip
+ *   "gpiomem"            register access through /dev/gpiomem
+ *   "gpiomem:<file>"     register access on a file-backed emulated register
+ *                        block (created if missing), for hosts without a Pi
+ *
+ * Building with -DGPIO_NO_GPIOD (make GPIOD=0) leaves out libgpiod, only
+ * the gpiomem specs are accepted then.
+ */
+
+#ifndef GPIO_BACKEND_H
+#define GPIO_BACKEND_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#ifndef GPIO_NO_GPIOD
+#include <gpiod.h>
+#else
+struct gpiod_chip;
+struct gpiod_line;
+#endif
+
+#define GPIO_MAX_LINES   58 // BCM2711 has GPIO 0..57 in two banks
+
+// BCM2711 GPIO register offsets, in 32-bit words from the block base
+#define GPIO_REG_GPFSEL0 0  // function select, 3 bits per line, 10 lines per register
+#define GPIO_REG_GPSET0  7  // write 1 to drive a line high
+#define GPIO_REG_GPCLR0  10 // write 1 to drive a line low
+#define GPIO_REG_GPLEV0  13 // current pin level
+#define GPIO_MAP_SIZE    4096
+
+#define GPIO_DEV_GPIOMEM "/dev/gpiomem"
+
+enum gpio_backend_type {
+    GPIO_BACKEND_GPIOD,
+    GPIO_BACKEND_GPIOMEM,
+};
+
+struct gpio_dev {
+    enum gpio_backend_type type;
+    int emulated;                               // registers live in a plain file
+
+    // libgpiod backend
+    struct gpiod_chip *chip;
+    struct gpiod_line *lines[GPIO_MAX_LINES];
+
+    // gpiomem backend
+    int mem_fd;
+    volatile uint32_t *regs;
+};
+
+int  gpio_open(struct gpio_dev *dev, const char *spec);
+void gpio_close(struct gpio_dev *dev);
+
+int  gpio_request_output(struct gpio_dev *dev, unsigned int line, int value, const char *consumer);
+int  gpio_request_input(struct gpio_dev *dev, unsigned int line, const char *consumer);
+int  gpio_get(struct gpio_dev *dev, unsigned int line);
+
+// Hot path: kept inline so the gpiomem backend compiles down to one store
+static inline int gpio_set(struct gpio_dev *dev, unsigned int line, int value) {
+    if (line >= GPIO_MAX_LINES) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (dev->type == GPIO_BACKEND_GPIOMEM) {
+        uint32_t bit = 1u << (line & 31);
+        unsigned int bank = line >> 5;
+
+        dev->regs[(value ? GPIO_REG_GPSET0 : GPIO_REG_GPCLR0) + bank] = bit;
+        if (dev->emulated) {
+            // Real hardware reflects set/clear in GPLEV, the emulation has to do it itself
+            if (value) {
+                dev->regs[GPIO_REG_GPLEV0 + bank] |= bit;
+            } else {
+                dev->regs[GPIO_REG_GPLEV0 + bank] &= ~bit;
+            }
+        }
+        return 0;
+    }
+#ifndef GPIO_NO_GPIOD
+    if (!dev->lines[line]) { // never requested
+        errno = EINVAL;
+        return -1;
+    }
+    return gpiod_line_set_value(dev->lines[line], value);
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+#endif // GPIO_BACKEND_H
@@ -0,0 +1,439 @@
+/*
+ * gpio_eventd.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Description:
+ * Long-running daemon that ties the push button, the LED and the SSD1306
+ * display together in a single thread. Everything is driven from one epoll
+ * loop over:
+ *   - the button line event fd (GPIO 17, rising edge)
+ *   - a timerfd used for LED blinking
+ *   - a timerfd used to coalesce display flushes
+ *   - a signalfd for SIGINT/SIGTERM
+ *   - a unix control socket and its connected clients
+ * No fd is polled: without button presses, blinking or client traffic the
+ * process stays asleep in epoll_wait().
+ *
+ * Control protocol (one command per line, answered with "ok" or "err ..."):
+ *   led on|off|toggle
+ *   blink <period_ms>       (0 stops blinking)
+ *   text <page 4-7> <string>
+ *   clear
+ *   status
+ *
+ * example: echo "led toggle" | socat - UNIX-CONNECT:/tmp/gpio_eventd.sock
+ *
+ * connections: button on GPIO 17, LED on GPIO 18 (same as gpio_pb_led.c),
+ * SSD1306 wired as described in ssd1306_spi.c
+ *
+ * build: make gpio_eventd
+ */
+
+#define _GNU_SOURCE // accept4()
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <gpiod.h>
+#include "evloop.h"
+#include "rt_util.h"
+#include "ssd1306.h"
+
+#define GPIO_CHIP        "gpiochip0"
+#define BUTTON_GPIO_PIN  17
+#define LED_GPIO_PIN     18
+
+#define CTRL_SOCKET_PATH "/tmp/gpio_eventd.sock"
+#define MAX_CLIENTS      8
+#define CMD_BUF_SIZE     128
+
+#define DEBOUNCE_NS      (200 * 1000000LL) // same debounce window as gpio_pb_led.c
+#define FLUSH_DELAY_MS   20                // coalesce display updates within this window
+
+struct client {
+    struct source src;
+    char buf[CMD_BUF_SIZE];
+    size_t len;
+};
+
+static struct gpiod_chip *chip;
+static struct gpiod_line *button_line;
+static struct gpiod_line *led_line;
+
+static struct source button_src;
+static struct source blink_src;
+static struct source flush_src;
+static struct source signal_src;
+static struct source listen_src;
+static struct client clients[MAX_CLIENTS];
+
+static struct ssd1306 oled;
+static int have_display;
+static int flush_armed;
+
+static int led_state;
+static unsigned int blink_ms;
+static unsigned long presses;
+static long long last_press_ns = -DEBOUNCE_NS;
+
+static void arm_timer(int fd, unsigned int delay_ms, unsigned int period_ms) {
+    struct itimerspec its = {
+        .it_value    = { delay_ms / 1000, (delay_ms % 1000) * 1000000L },
+        .it_interval = { period_ms / 1000, (period_ms % 1000) * 1000000L },
+    };
+    timerfd_settime(fd, 0, &its, NULL);
+}
+
+static void drain_timer(int fd) {
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+        perror("timerfd read");
+    }
+}
+
+// Mark the display as changed; the actual SPI traffic happens in flush_handler
+static void schedule_flush(void) {
+    if (!have_display || flush_armed) {
+        return;
+    }
+    arm_timer(flush_src.fd, FLUSH_DELAY_MS, 0);
+    flush_armed = 1;
+}
+
+static void draw_status(void) {
+    char line[SSD1306_WIDTH / SSD1306_FONT_WIDTH + 1];
+
+    if (!have_display) {
+        return;
+    }
+    ssd1306_fb_clear_page(&oled, 2);
+    snprintf(line, sizeof(line), "LED: %s", blink_ms ? "BLINK" : (led_state ? "ON" : "OFF"));
+    ssd1306_fb_draw_string(&oled, 0, 2, line);
+
+    ssd1306_fb_clear_page(&oled, 3);
+    snprintf(line, sizeof(line), "presses: %lu", presses);
+    ssd1306_fb_draw_string(&oled, 0, 3, line);
+
+    schedule_flush();
+}
+
+static void set_led(int value) {
+    led_state = value;
+    if (gpiod_line_set_value(led_line, led_state) < 0) {
+        perror("Failed to write LED GPIO value");
+    }
+}
+
+static void set_blink(unsigned int period_ms) {
+    blink_ms = period_ms;
+    arm_timer(blink_src.fd, period_ms, period_ms); // zero disarms the timer
+}
+
+static void button_handler(struct source *src, uint32_t events) {
+    struct gpiod_line_event event;
+    (void)src;
+    (void)events;
+
+    if (gpiod_line_event_read(button_line, &event) < 0) {
+        perror("Failed to read button event");
+        return;
+    }
+
+    // Debounce on the kernel timestamp, not on the time we got scheduled
+    long long ts_ns = event.ts.tv_sec * 1000000000LL + event.ts.tv_nsec;
+    if (ts_ns - last_press_ns < DEBOUNCE_NS) {
+        return;
+    }
+    last_press_ns = ts_ns;
+
+    presses++;
+    set_blink(0);
+    set_led(!led_state);
+    draw_status();
+}
+
+static void blink_handler(struct source *src, uint32_t events) {
+    (void)events;
+    drain_timer(src->fd);
+    set_led(!led_state);
+}
+
+static void flush_handler(struct source *src, uint32_t events) {
+    (void)events;
+    drain_timer(src->fd);
+    flush_armed = 0;
+    ssd1306_flush(&oled);
+}
+
+static void signal_handler(struct source *src, uint32_t events) {
+    struct signalfd_siginfo info;
+    (void)events;
+
+    if (read(src->fd, &info, sizeof(info)) == sizeof(info)) {
+        printf("Received signal %u, shutting down\n", info.ssi_signo);
+    }
+    evloop_stop();
+}
+
+static void client_reply(struct client *c, const char *msg) {
+    size_t len = strlen(msg);
+    // Replies are tiny; a client that does not read them just loses them
+    if (send(c->src.fd, msg, len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0 && errno != EAGAIN) {
+        perror("send");
+    }
+}
+
+static void handle_command(struct client *c, char *cmd) {
+    char reply[64];
+    char *arg = strchr(cmd, ' ');
+
+    if (arg) {
+        *arg++ = '\0';
+    }
+
+    if (!strcmp(cmd, "led") && arg) {
+        if (!strcmp(arg, "on")) {
+            set_blink(0);
+            set_led(1);
+        } else if (!strcmp(arg, "off")) {
+            set_blink(0);
+            set_led(0);
+        } else if (!strcmp(arg, "toggle")) {
+            set_blink(0);
+            set_led(!led_state);
+        } else {
+            client_reply(c, "err invalid led state\n");
+            return;
+        }
+        draw_status();
+    } else if (!strcmp(cmd, "blink") && arg) {
+        set_blink((unsigned int)strtoul(arg, NULL, 10));
+        draw_status();
+    } else if (!strcmp(cmd, "text") && arg) {
+        char *end;
+        unsigned long page = strtoul(arg, &end, 10);
+        if (end == arg || page < 4 || page >= SSD1306_PAGES) {
+            client_reply(c, "err page must be 4-7\n");
+            return;
+        }
+        if (have_display) {
+            ssd1306_fb_clear_page(&oled, (uint8_t)page);
+            ssd1306_fb_draw_string(&oled, 0, (uint8_t)page, *end ? end + 1 : end);
+            schedule_flush();
+        }
+    } else if (!strcmp(cmd, "clear")) {
+        if (have_display) {
+            for (uint8_t page = 4; page < SSD1306_PAGES; page++) {
+                ssd1306_fb_clear_page(&oled, page);
+            }
+            schedule_flush();
+        }
+    } else if (!strcmp(cmd, "status")) {
+        snprintf(reply, sizeof(reply), "led=%d blink=%u presses=%lu display=%d\n",
+                 led_state, blink_ms, presses, have_display);
+        client_reply(c, reply);
+        return;
+    } else {
+        client_reply(c, "err unknown command\n");
+        return;
+    }
+    client_reply(c, "ok\n");
+}
+
+static void client_handler(struct source *src, uint32_t events) {
+    struct client *c = (struct client *)src;
+    ssize_t n;
+    (void)events;
+
+    n = read(src->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len);
+    if (n <= 0) {
+        if (n < 0 && errno == EAGAIN) {
+            return;
+        }
+        remove_source(src);
+        return;
+    }
+    c->len += (size_t)n;
+    c->buf[c->len] = '\0';
+
+    // Execute every complete line, keep a trailing partial line for later
+    char *line = c->buf;
+    char *nl;
+    while ((nl = strchr(line, '\n'))) {
+        *nl = '\0';
+        if (nl > line && nl[-1] == '\r') {
+            nl[-1] = '\0';
+        }
+        if (*line) {
+            handle_command(c, line);
+        }
+        line = nl + 1;
+    }
+    c->len = strlen(line);
+    memmove(c->buf, line, c->len);
+
+    if (c->len == sizeof(c->buf) - 1) {
+        client_reply(c, "err command too long\n");
+        c->len = 0;
+    }
+}
+
+static void listen_handler(struct source *src, uint32_t events) {
+    int fd = accept4(src->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    (void)events;
+
+    if (fd < 0) {
+        perror("accept");
+        return;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].src.fd < 0) {
+            clients[i].len = 0;
+            if (add_source(&clients[i].src, fd, client_handler) < 0) {
+                close(fd);
+            }
+            return;
+        }
+    }
+    fprintf(stderr, "Too many control clients, dropping connection\n");
+    close(fd);
+}
+
+static int open_gpio(void) {
+    chip = gpiod_chip_open_by_name(GPIO_CHIP);
+    if (!chip) {
+        perror("Failed to open GPIO chip");
+        return -1;
+    }
+
+    button_line = gpiod_chip_get_line(chip, BUTTON_GPIO_PIN);
+    led_line = gpiod_chip_get_line(chip, LED_GPIO_PIN);
+    if (!button_line || !led_line) {
+        perror("Failed to get GPIO lines");
+        goto Error;
+    }
+
+    if (gpiod_line_request_rising_edge_events(button_line, "gpio_eventd") < 0) {
+        perror("Failed to request button events");
+        goto Error;
+    }
+
+    if (gpiod_line_request_output(led_line, "gpio_eventd", 0) < 0) {
+        perror("Failed to request LED line as output");
+        goto Error;
+    }
+    return 0;
+Error:
+    gpiod_chip_close(chip);
+    return -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-s socket_path] [-g gpio_spec] [-r rt_priority] [-n]\n"
+                    "  -s  control socket path (default %s)\n"
+                    "  -g  GPIO backend for the display DC/RESET lines (default %s)\n"
+                    "  -r  run with SCHED_FIFO at the given priority\n"
+                    "  -n  run without the SSD1306 display\n",
+            prog, CTRL_SOCKET_PATH, SSD1306_GPIO_CHIP);
+}
+
+int main(int argc, char *argv[]) {
+    const char *sock_path = CTRL_SOCKET_PATH;
+    const char *display_gpio = SSD1306_GPIO_CHIP;
+    int rt_prio = 0;
+    int use_display = 1;
+    int ret = EXIT_FAILURE;
+    int opt;
+    sigset_t mask;
+
+    while ((opt = getopt(argc, argv, "s:g:r:nh")) != -1) {
+        switch (opt) {
+        case 's': sock_path = optarg; break;
+        case 'g': display_gpio = optarg; break;
+        case 'r': rt_prio = atoi(optarg); break;
+        case 'n': use_display = 0; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].src.fd = -1;
+    }
+
+    if (evloop_init() < 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (open_gpio() < 0) {
+        goto EpollError;
+    }
+
+    // Signals are consumed through the loop like everything else
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+
+    int listen_fd = open_control_socket(sock_path, MAX_CLIENTS);
+    if (listen_fd < 0 ||
+        add_source(&button_src, gpiod_line_event_get_fd(button_line), button_handler) < 0 ||
+        add_source(&blink_src, timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), blink_handler) < 0 ||
+        add_source(&flush_src, timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), flush_handler) < 0 ||
+        add_source(&signal_src, signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC), signal_handler) < 0 ||
+        add_source(&listen_src, listen_fd, listen_handler) < 0) {
+        goto GpioError;
+    }
+
+    if (use_display) {
+        if (ssd1306_open(&oled, SSD1306_SPI_PATH, display_gpio) == 0) {
+            ssd1306_fb_clear(&oled);
+            if (ssd1306_init(&oled) == 0) {
+                have_display = 1;
+                ssd1306_fb_draw_string(&oled, 0, 0, "gpio_eventd");
+                draw_status();
+            } else {
+                ssd1306_close(&oled);
+            }
+        }
+        if (!have_display) {
+            fprintf(stderr, "Continuing without display\n");
+        }
+    }
+
+    if (rt_prio > 0) {
+        make_realtime(rt_prio);
+    }
+
+    printf("gpio_eventd running, control socket %s\n", sock_path);
+
+    evloop_run();
+
+    // Cleanup
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].src.fd >= 0) {
+            remove_source(&clients[i].src);
+        }
+    }
+    unlink(sock_path);
+    if (have_display) {
+        ssd1306_fb_clear(&oled);
+        ssd1306_flush(&oled);
+        ssd1306_close(&oled);
+    }
+    gpiod_line_set_value(led_line, 0);
+    ret = EXIT_SUCCESS;
+GpioError:
+    gpiod_chip_close(chip);
+EpollError:
+    evloop_close();
+    return ret;
+}
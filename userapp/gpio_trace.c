@@ -0,0 +1,415 @@
+/*
+ * gpio_trace.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Description:
+ * Capture GPIO line events with their kernel timestamps into a compact
+ * binary trace (see gpio_trace.h) and replay them deterministically into
+ * gpio-sim, at the original rate or accelerated. Lets debounce, event
+ * queue and IRQ path changes be tested against real field traces.
+ *
+ * usage:
+ *   gpio_trace capture [-c chip] [-n max_events] [-t seconds] <file> <line>...
+ *   gpio_trace replay  [-s speed] [-p rt_prio] [-m line=sim,...] <file> <gpio-sim chip dir>
+ *   gpio_trace dump    <file>
+ *
+ * replay writes the pull attribute of a sim_gpio<n> below the chip dir,
+ * e.g. /sys/devices/platform/gpio-sim.0/gpiochip2 (scripts/gpio_sim_setup.sh).
+ * The captured lines go to sim lines 0, 1, ... in capture order, so a
+ * trace of GPIO17 fits the default 8 line sim chip; -m 17=3 picks the sim
+ * line explicitly. Consecutive events with the same edge on a line (a
+ * dropped event in the capture) cannot produce an edge and are counted.
+ * speed 1 is the original timing, 10 is ten times faster, 0 is as fast as
+ * possible.
+ *
+ * build: make gpio_trace
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <gpiod.h>
+#include "gpio_trace.h"
+#include "rt_util.h"
+
+#define EVENT_BATCH 16
+
+static int cmp_event(const void *a, const void *b) {
+    const struct gpio_trace_event *x = a;
+    const struct gpio_trace_event *y = b;
+    return (x->ts_ns > y->ts_ns) - (x->ts_ns < y->ts_ns);
+}
+
+/*
+ * Map a trace file and validate its header. Returns the header, the events
+ * follow it directly.
+ */
+static struct gpio_trace_header *trace_map(const char *path, int writable, size_t *map_len) {
+    struct stat st;
+    int fd = open(path, writable ? O_RDWR : O_RDONLY);
+
+    if (fd < 0) {
+        perror("Failed to open trace");
+        return NULL;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct gpio_trace_header)) {
+        fprintf(stderr, "%s: not a GPIO trace\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Failed to map trace");
+        return NULL;
+    }
+
+    struct gpio_trace_header *hdr = map;
+    size_t max_events = ((size_t)st.st_size - sizeof(*hdr)) / sizeof(struct gpio_trace_event);
+    if (memcmp(hdr->magic, GPIO_TRACE_MAGIC, sizeof(hdr->magic)) || hdr->version != GPIO_TRACE_VERSION ||
+        hdr->num_lines > GPIO_TRACE_MAX_LINES || hdr->count > max_events) {
+        fprintf(stderr, "%s: not a GPIO trace or unsupported version\n", path);
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    *map_len = (size_t)st.st_size;
+    return hdr;
+}
+
+static int capture(int argc, char *argv[]) {
+    const char *chip_name = "gpiochip0";
+    unsigned long max_events = 0;
+    unsigned int seconds = 0;
+    struct gpio_trace_header hdr = { .version = GPIO_TRACE_VERSION };
+    struct gpiod_line *lines[GPIO_TRACE_MAX_LINES];
+    int ret = EXIT_FAILURE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:t:")) != -1) {
+        switch (opt) {
+        case 'c': chip_name = optarg; break;
+        case 'n': max_events = strtoul(optarg, NULL, 10); break;
+        case 't': seconds = (unsigned int)strtoul(optarg, NULL, 10); break;
+        default: return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind < 2 || argc - optind - 1 > GPIO_TRACE_MAX_LINES) {
+        fprintf(stderr, "Usage: gpio_trace capture [-c chip] [-n max_events] [-t seconds] <file> <line>...\n");
+        return EXIT_FAILURE;
+    }
+    const char *path = argv[optind++];
+
+    memcpy(hdr.magic, GPIO_TRACE_MAGIC, sizeof(hdr.magic));
+    snprintf(hdr.chip, sizeof(hdr.chip), "%s", chip_name);
+
+    struct gpiod_chip *chip = gpiod_chip_open_by_name(chip_name);
+    if (!chip) {
+        perror("Failed to open GPIO chip");
+        return EXIT_FAILURE;
+    }
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int sfd = -1;
+    for (; optind < argc; optind++) {
+        unsigned int idx = hdr.num_lines++;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = idx };
+
+        hdr.lines[idx] = (uint32_t)strtoul(argv[optind], NULL, 10);
+        lines[idx] = gpiod_chip_get_line(chip, hdr.lines[idx]);
+        if (!lines[idx] || gpiod_line_request_both_edges_events(lines[idx], "gpio_trace") < 0) {
+            fprintf(stderr, "Failed to request events on line %u: %s\n", hdr.lines[idx], strerror(errno));
+            goto ChipError;
+        }
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, gpiod_line_event_get_fd(lines[idx]), &ev) < 0) {
+            perror("epoll_ctl");
+            goto ChipError;
+        }
+    }
+
+    // Stop cleanly on Ctrl-C so the header gets finalized
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    sfd = signalfd(-1, &mask, SFD_CLOEXEC);
+    struct epoll_event sev = { .events = EPOLLIN, .data.u32 = GPIO_TRACE_MAX_LINES };
+    epoll_ctl(epfd, EPOLL_CTL_ADD, sfd, &sev);
+
+    FILE *out = fopen(path, "w+");
+    if (!out) {
+        perror("Failed to create trace");
+        goto ChipError;
+    }
+    // Placeholder header, rewritten once the event count is known
+    fwrite(&hdr, sizeof(hdr), 1, out);
+
+    fprintf(stderr, "Capturing %u line(s) on %s, Ctrl-C to stop\n", hdr.num_lines, chip_name);
+
+    int64_t deadline = seconds ? now_ns() + seconds * 1000000000LL : 0;
+    int running = 1;
+    while (running && (!max_events || hdr.count < max_events)) {
+        struct epoll_event events[GPIO_TRACE_MAX_LINES + 1];
+        int timeout = -1;
+
+        if (deadline) {
+            int64_t left = deadline - now_ns();
+            if (left <= 0) {
+                break;
+            }
+            timeout = (int)(left / 1000000) + 1;
+        }
+
+        int n = epoll_wait(epfd, events, GPIO_TRACE_MAX_LINES + 1, timeout);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            struct gpiod_line_event batch[EVENT_BATCH];
+            unsigned int idx = events[i].data.u32;
+
+            if (idx == GPIO_TRACE_MAX_LINES) {
+                running = 0;
+                continue;
+            }
+            int got = gpiod_line_event_read_multiple(lines[idx], batch, EVENT_BATCH);
+            for (int e = 0; e < got && (!max_events || hdr.count < max_events); e++) {
+                struct gpio_trace_event rec = {
+                    .ts_ns = (uint64_t)batch[e].ts.tv_sec * 1000000000ULL + (uint64_t)batch[e].ts.tv_nsec,
+                    .line = hdr.lines[idx],
+                    .edge = batch[e].event_type == GPIOD_LINE_EVENT_RISING_EDGE ? GPIO_TRACE_RISING : GPIO_TRACE_FALLING,
+                };
+                fwrite(&rec, sizeof(rec), 1, out);
+                hdr.count++;
+            }
+        }
+    }
+
+    if (fflush(out) != 0 || fclose(out) != 0) {
+        perror("Failed to write trace");
+        goto ChipError;
+    }
+
+    // Events of different lines arrive through different fds; sort them in place
+    size_t map_len;
+    struct gpio_trace_header *mapped = trace_map(path, 1, &map_len);
+    if (!mapped) {
+        goto ChipError;
+    }
+    struct gpio_trace_event *ev = (struct gpio_trace_event *)(mapped + 1);
+    mapped->count = hdr.count;
+    qsort(ev, hdr.count, sizeof(*ev), cmp_event);
+    if (hdr.count) {
+        mapped->first_ns = ev[0].ts_ns;
+        mapped->last_ns = ev[hdr.count - 1].ts_ns;
+    }
+    munmap(mapped, map_len);
+
+    fprintf(stderr, "Captured %llu events into %s\n", (unsigned long long)hdr.count, path);
+    ret = EXIT_SUCCESS;
+ChipError:
+    if (sfd >= 0) {
+        close(sfd);
+    }
+    close(epfd);
+    gpiod_chip_close(chip);
+    return ret;
+}
+
+static int replay(int argc, char *argv[]) {
+    double speed = 1.0;
+    int prio = 0;
+    const char *map = NULL;
+    int sim_fd[GPIO_TRACE_MAX_LINES];
+    uint32_t last_edge[GPIO_TRACE_MAX_LINES] = { 0 };
+    int ret = EXIT_FAILURE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:p:m:")) != -1) {
+        switch (opt) {
+        case 's': speed = strtod(optarg, NULL); break;
+        case 'p': prio = atoi(optarg); break;
+        case 'm': map = optarg; break;
+        default: return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind != 2 || speed < 0) {
+        fprintf(stderr, "Usage: gpio_trace replay [-s speed] [-p rt_prio] [-m line=sim,...] <file> <gpio-sim chip dir>\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t map_len;
+    struct gpio_trace_header *hdr = trace_map(argv[optind], 0, &map_len);
+    if (!hdr) {
+        return EXIT_FAILURE;
+    }
+    const struct gpio_trace_event *ev = (const struct gpio_trace_event *)(hdr + 1);
+
+    // Captured line i goes to sim line i unless -m says otherwise
+    unsigned int sim_line[GPIO_TRACE_MAX_LINES];
+    for (unsigned int i = 0; i < hdr->num_lines; i++) {
+        sim_line[i] = i;
+    }
+    for (const char *m = map; m && *m; ) {
+        unsigned int line, sim, i = 0;
+        int used;
+        if (sscanf(m, "%u=%u%n", &line, &sim, &used) != 2) {
+            fprintf(stderr, "Invalid line map \"%s\", expected line=sim[,line=sim...]\n", map);
+            goto MapError;
+        }
+        while (i < hdr->num_lines && hdr->lines[i] != line) {
+            i++;
+        }
+        if (i == hdr->num_lines) {
+            fprintf(stderr, "Line %u is not in the trace\n", line);
+            goto MapError;
+        }
+        sim_line[i] = sim;
+        m += used;
+        m += *m == ',';
+    }
+
+    // One pull attribute per captured line, looked up by line index in the event loop
+    for (unsigned int i = 0; i < hdr->num_lines; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/sim_gpio%u/pull", argv[optind + 1], sim_line[i]);
+        sim_fd[i] = open(path, O_WRONLY | O_CLOEXEC);
+        if (sim_fd[i] < 0) {
+            fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+            while (i--) {
+                close(sim_fd[i]);
+            }
+            goto MapError;
+        }
+    }
+
+    for (unsigned int i = 0; i < hdr->num_lines; i++) {
+        fprintf(stderr, "line %u -> sim_gpio%u\n", hdr->lines[i], sim_line[i]);
+    }
+
+    for (unsigned int i = 0; i < hdr->num_lines; i++) {
+        // Start every line at the level opposite to its first edge, so that edge fires
+        for (uint64_t e = 0; e < hdr->count; e++) {
+            if (ev[e].line == hdr->lines[i]) {
+                const char *pull = ev[e].edge == GPIO_TRACE_RISING ? "pull-down" : "pull-up";
+                if (pwrite(sim_fd[i], pull, strlen(pull), 0) < 0) {
+                    perror("Failed to write gpio-sim pull");
+                }
+                break;
+            }
+        }
+    }
+
+    if (prio > 0) {
+        make_realtime(prio);
+    }
+
+    fprintf(stderr, "Replaying %llu events (%.3f s captured) at speed %g\n",
+            (unsigned long long)hdr->count, (hdr->last_ns - hdr->first_ns) / 1e9, speed);
+
+    int64_t start = now_ns() + (speed > 0 ? 1000000 : 0); // 1 ms head start for the first deadline
+    int64_t max_lag = 0;
+    int64_t total_lag = 0;
+    uint64_t repeated = 0;
+    for (uint64_t e = 0; e < hdr->count; e++) {
+        unsigned int idx = 0;
+        while (idx < hdr->num_lines && hdr->lines[idx] != ev[e].line) {
+            idx++;
+        }
+        if (idx == hdr->num_lines) {
+            continue;
+        }
+
+        if (speed > 0) {
+            int64_t due = start + (int64_t)((double)(ev[e].ts_ns - hdr->first_ns) / speed);
+            struct timespec ts = { due / 1000000000LL, due % 1000000000LL };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+            }
+            int64_t lag = now_ns() - due;
+            total_lag += lag;
+            if (lag > max_lag) {
+                max_lag = lag;
+            }
+        }
+
+        // Same edge twice in a row: the level is already there, no edge gets injected
+        if (ev[e].edge == last_edge[idx]) {
+            repeated++;
+        }
+        last_edge[idx] = ev[e].edge;
+
+        const char *pull = ev[e].edge == GPIO_TRACE_RISING ? "pull-up" : "pull-down";
+        if (pwrite(sim_fd[idx], pull, strlen(pull), 0) < 0) {
+            perror("Failed to write gpio-sim pull");
+            break;
+        }
+    }
+
+    fprintf(stderr, "Replay done in %.3f s", (now_ns() - start) / 1e9);
+    if (speed > 0 && hdr->count) {
+        fprintf(stderr, ", scheduling lag avg %.1f us, max %.1f us",
+                total_lag / 1000.0 / (double)hdr->count, max_lag / 1000.0);
+    }
+    fprintf(stderr, "\n");
+    if (repeated) {
+        fprintf(stderr, "Warning: %llu event(s) repeated the previous edge of their line and injected no edge "
+                        "(events dropped during capture?)\n", (unsigned long long)repeated);
+    }
+
+    for (unsigned int i = 0; i < hdr->num_lines; i++) {
+        close(sim_fd[i]);
+    }
+    ret = EXIT_SUCCESS;
+MapError:
+    munmap(hdr, map_len);
+    return ret;
+}
+
+static int dump(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: gpio_trace dump <file>\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t map_len;
+    struct gpio_trace_header *hdr = trace_map(argv[1], 0, &map_len);
+    if (!hdr) {
+        return EXIT_FAILURE;
+    }
+    const struct gpio_trace_event *ev = (const struct gpio_trace_event *)(hdr + 1);
+
+    printf("chip %s, %u line(s), %llu events\n", hdr->chip, hdr->num_lines, (unsigned long long)hdr->count);
+    for (uint64_t e = 0; e < hdr->count; e++) {
+        printf("%14.6f ms  line %2u  %s\n", (ev[e].ts_ns - hdr->first_ns) / 1e6, ev[e].line,
+               ev[e].edge == GPIO_TRACE_RISING ? "rising" : "falling");
+    }
+
+    munmap(hdr, map_len);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 2 && !strcmp(argv[1], "capture")) {
+        return capture(argc - 1, argv + 1);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "replay")) {
+        return replay(argc - 1, argv + 1);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "dump")) {
+        return dump(argc - 1, argv + 1);
+    }
+    fprintf(stderr, "Usage: %s capture|replay|dump ...\n", argv[0]);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,45 @@
+/*
+ * gpio_trace.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * On-disk format of GPIO event traces written by gpio_trace capture.
+ * A trace is a fixed-size header followed by an array of fixed-size
+ * events sorted by timestamp, so the whole file can be mmap()ed and used
+ * in place. All fields are little endian, as on the Pi.
+ */
+
+#ifndef GPIO_TRACE_H
+#define GPIO_TRACE_H
+
+#include <stdint.h>
+
+#define GPIO_TRACE_MAGIC     "GPIOTRC1"
+#define GPIO_TRACE_VERSION   1
+#define GPIO_TRACE_MAX_LINES 32
+
+enum gpio_trace_edge {
+    GPIO_TRACE_RISING  = 1,
+    GPIO_TRACE_FALLING = 2,
+};
+
+struct gpio_trace_header {
+    char     magic[8];                       // GPIO_TRACE_MAGIC, not NUL terminated
+    uint32_t version;
+    uint32_t num_lines;
+    uint32_t lines[GPIO_TRACE_MAX_LINES];    // captured line offsets on the chip
+    char     chip[32];                       // chip name, NUL terminated
+    uint64_t count;                          // number of events after the header
+    uint64_t first_ns;                       // timestamp of the first event
+    uint64_t last_ns;                        // timestamp of the last event
+};
+
+struct gpio_trace_event {
+    uint64_t ts_ns;     // kernel line event timestamp (CLOCK_MONOTONIC)
+    uint32_t line;      // line offset on the chip
+    uint32_t edge;      // enum gpio_trace_edge
+};
+
+_Static_assert(sizeof(struct gpio_trace_header) % 8 == 0, "events must stay 8 byte aligned");
+_Static_assert(sizeof(struct gpio_trace_event) == 16, "event layout is part of the file format");
+
+#endif // GPIO_TRACE_H
@@ -2,40 +2,33 @@
  * led_gpio17.c
  * author: Venkata Naga Ravikiran Bulusu
  *
+ * usage: ./led_gpio17 [gpio spec]   (default "gpiochip0", see gpio_backend.h)
+ * build: make led_gpio17
  */
 
-#include <gpiod.h>
 #include <stdio.h>
 #include <unistd.h>
+#include "gpio_backend.h"
 
-int main() {
-    const char *chipname = "gpiochip0";
+int main(int argc, char *argv[]) {
+    const char *spec = argc > 1 ? argv[1] : "gpiochip0";
     unsigned int line_num = 17; // GPIO pin number
     int val = 1; // Value to set
+    struct gpio_dev gpio;
 
-    struct gpiod_chip *chip = gpiod_chip_open_by_name(chipname);
-    if (!chip) {
-        perror("Open chip failed\n");
+    if (gpio_open(&gpio, spec) < 0) {
         return -1;
     }
 
-    struct gpiod_line *line = gpiod_chip_get_line(chip, line_num);
-    if (!line) {
-        perror("Get line failed\n");
-        gpiod_chip_close(chip);
+    if (gpio_request_output(&gpio, line_num, val, "gpio_control") < 0) {
+        gpio_close(&gpio);
         return -1;
     }
 
-    if (gpiod_line_request_output(line, "gpio_control", val) < 0) {
-        perror("Request line as output failed\n");
-        gpiod_chip_close(chip);
-        return -1;
-    }
-
-    gpiod_line_set_value(line, 1); // Turn on LED
-    sleep(2);                      // Keep LED on for 2 seconds
-    gpiod_line_set_value(line, 0); // Turn off LED
+    gpio_set(&gpio, line_num, 1); // Turn on LED
+    sleep(2);                     // Keep LED on for 2 seconds
+    gpio_set(&gpio, line_num, 0); // Turn off LED
 
-    gpiod_chip_close(chip);
+    gpio_close(&gpio);
     return 0;
-}
\ No newline at end of file
+}
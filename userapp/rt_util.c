@@ -0,0 +1,30 @@
+/*
+ * rt_util.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Timing and scheduling helpers shared by the userspace programs.
+ */
+
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "rt_util.h"
+
+int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void make_realtime(int prio) {
+    struct sched_param param = { .sched_priority = prio };
+
+    // Separate calls: SCHED_FIFO is still worth having when locking fails
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        perror("mlockall");
+    }
+    if (sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+        perror("Failed to switch to SCHED_FIFO");
+    }
+}
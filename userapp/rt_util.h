@@ -0,0 +1,22 @@
+/*
+ * rt_util.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Timing and scheduling helpers shared by the userspace programs.
+ */
+
+#ifndef RT_UTIL_H
+#define RT_UTIL_H
+
+#include <stdint.h>
+
+// CLOCK_MONOTONIC in nanoseconds
+int64_t now_ns(void);
+
+/*
+ * Lock all memory and switch to SCHED_FIFO at prio. Failures are reported
+ * and otherwise ignored, the caller keeps running without them.
+ */
+void make_realtime(int prio);
+
+#endif // RT_UTIL_H
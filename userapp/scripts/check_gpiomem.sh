@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# check_gpiomem.sh
+# author: Venkata Naga Ravikiran Bulusu
+#
+# Host check of the emulated gpiomem backend (run by "make check"): drive
+# GPIO17 with led_gpio17 on a file-backed register block and verify the
+# function select and level registers while it is high and after it is done.
+
+REGS=$(mktemp /tmp/gpiomem.XXXXXX)
+trap 'rm -f $REGS' EXIT
+rm -f $REGS # led_gpio17 creates a fresh all-zero block
+
+LINE=17
+FAILED=0
+
+# Read a 32-bit register, offset in words from the block base
+reg() {
+    od -An -tu4 -j $(($1 * 4)) -N4 $REGS | tr -d ' '
+}
+
+# Poll a register bit until it reads the expected value, up to ~5 s
+wait_bit() {
+    for i in $(seq 100); do
+        if [ -s $REGS ] && [ $(( ($(reg $1) >> $2) & 1 )) -eq $3 ]; then
+            return 0
+        fi
+        sleep 0.05
+    done
+    return 1
+}
+
+check() {
+    if [ "$2" != "$3" ]; then
+        echo "FAIL: $1 is $2, expected $3"
+        FAILED=1
+    else
+        echo "ok:   $1 = $2"
+    fi
+}
+
+./led_gpio17 gpiomem:$REGS &
+PID=$!
+
+# led_gpio17 keeps the line high for 2 s
+if wait_bit 13 $LINE 1; then
+    echo "ok:   GPLEV0 line $LINE went high"
+else
+    echo "FAIL: GPLEV0 line $LINE never went high"
+    FAILED=1
+fi
+
+if ! wait $PID; then
+    echo "FAIL: led_gpio17 exited with an error"
+    FAILED=1
+fi
+
+# GPFSEL1 holds lines 10..19, function 1 (output) for line 17 at bits 21..23
+check "GPFSEL1 line $LINE" $(( ($(reg 1) >> 21) & 7 )) 1
+check "GPLEV0 line $LINE after off" $(( ($(reg 13) >> LINE) & 1 )) 0
+check "GPCLR0 last write" $(reg 10) $((1 << LINE))
+
+exit $FAILED
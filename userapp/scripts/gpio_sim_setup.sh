@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# gpio_sim_setup.sh
+# author: Venkata Naga Ravikiran Bulusu
+#
+# Create or remove a gpio-sim chip used to inject edges for the GPIO
+# benchmarks and the trace replay tool. Needs CONFIG_GPIO_SIM and configfs.
+
+SIM_NAME=elrpi4
+NUM_LINES=${2:-8}
+CONFIGFS=/sys/kernel/config/gpio-sim
+SIM_DIR=$CONFIGFS/$SIM_NAME
+
+# Print the global GPIO number of the first line of a chip. The legacy
+# sysfs entries are named gpiochip<base>, so match them by their device.
+chip_base() {
+    local dev=$(readlink -f /sys/bus/gpio/devices/$1)
+
+    for d in /sys/class/gpio/gpiochip*; do
+        if [ -e "$d/device" ] && [ "$(readlink -f $d/device)" == "$dev" ]; then
+            cat $d/base
+            return
+        fi
+    done
+    echo "unknown (needs CONFIG_GPIO_SYSFS)"
+}
+
+setup_sim() {
+    modprobe gpio-sim
+
+    if [ ! -d $CONFIGFS ]; then
+        echo "gpio-sim configfs not found, is configfs mounted?"
+        exit 1
+    fi
+
+    if [ ! -d $SIM_DIR ]; then
+        mkdir $SIM_DIR && mkdir $SIM_DIR/gpio-bank0
+        echo $NUM_LINES > $SIM_DIR/gpio-bank0/num_lines
+        echo 1 > $SIM_DIR/live
+
+        if [ $? -ne 0 ]; then
+            echo "Failed to enable the gpio-sim chip!"
+            exit 1
+        fi
+    fi
+
+    DEV_NAME=$(cat $SIM_DIR/dev_name)
+    CHIP_NAME=$(cat $SIM_DIR/gpio-bank0/chip_name)
+
+    echo "chip:  $CHIP_NAME"
+    echo "base:  $(chip_base $CHIP_NAME)"
+    echo "lines: /sys/devices/platform/$DEV_NAME/$CHIP_NAME/sim_gpio<N>/pull"
+}
+
+teardown_sim() {
+    if [ ! -d $SIM_DIR ]; then
+        echo "Nothing to remove."
+        exit 0
+    fi
+
+    echo 0 > $SIM_DIR/live
+    rmdir $SIM_DIR/gpio-bank0 $SIM_DIR
+
+    if [ $? -ne 0 ]; then
+        echo "Failed to remove the gpio-sim chip!"
+        exit 1
+    fi
+
+    echo "gpio-sim chip removed."
+}
+
+# Main script logic
+if [ "$1" == "setup" ]; then
+    setup_sim
+elif [ "$1" == "teardown" ]; then
+    teardown_sim
+else
+    echo "Usage: $0 [setup|teardown] [num_lines]"
+    exit 1
+fi
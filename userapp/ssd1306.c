@@ -0,0 +1,223 @@
+/*
+ * ssd1306.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#include <string.h>
+#include "ssd1306.h"
+
+static int ssd1306_set_dc(struct ssd1306 *dev, int value) {
+    // DC only changes between command and data bursts, skip redundant writes
+    if (dev->dc_state == value) {
+        return 0;
+    }
+    if (gpio_set(&dev->gpio, SSD1306_DC_PIN, value) < 0) {
+        perror("Failed to write DC GPIO value");
+        dev->dc_state = -1;
+        return -1;
+    }
+    dev->dc_state = value;
+    return 0;
+}
+
+static int ssd1306_write(struct ssd1306 *dev, int dc, const uint8_t *buf, size_t len) {
+    if (ssd1306_set_dc(dev, dc) < 0) {
+        return -1;
+    }
+    if (write(dev->spi_fd, buf, len) != (ssize_t)len) {
+        perror(dc ? "Failed to write data to SPI" : "Failed to write command to SPI");
+        return -1;
+    }
+    return 0;
+}
+
+int ssd1306_commands(struct ssd1306 *dev, const uint8_t *cmds, size_t len) {
+    return ssd1306_write(dev, 0, cmds, len);
+}
+
+int ssd1306_write_data(struct ssd1306 *dev, const uint8_t *buf, size_t len) {
+    return ssd1306_write(dev, 1, buf, len);
+}
+
+int ssd1306_set_speed(struct ssd1306 *dev, uint32_t hz) {
+    if (ioctl(dev->spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &hz) == -1) {
+        perror("Failed to set SPI speed");
+        return -1;
+    }
+    return 0;
+}
+
+int ssd1306_set_window(struct ssd1306 *dev, uint8_t x, uint8_t page, uint8_t w, uint8_t pages) {
+    if (!w || !pages || x + w > SSD1306_WIDTH || page + pages > SSD1306_PAGES) {
+        return -1;
+    }
+    const uint8_t window[] = {
+        0x21, x, x + w - 1,           // Column address range
+        0x22, page, page + pages - 1, // Page address range
+    };
+    return ssd1306_commands(dev, window, sizeof(window));
+}
+
+int ssd1306_open(struct ssd1306 *dev, const char *spi_path, const char *gpio_spec) {
+    memset(dev, 0, sizeof(*dev));
+    dev->dc_state = -1;
+
+    // Open SPI device
+    dev->spi_fd = open(spi_path, O_RDWR);
+    if (dev->spi_fd < 0) {
+        perror("Failed to open SPI device");
+        return -1;
+    }
+
+    // Configure SPI
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+    uint32_t speed = SSD1306_SPI_SPEED;
+    if (ioctl(dev->spi_fd, SPI_IOC_WR_MODE, &mode) == -1 ||
+        ioctl(dev->spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) == -1 ||
+        ioctl(dev->spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) == -1) {
+        perror("Failed to configure SPI");
+        goto SpiError;
+    }
+
+    // Initialize the DC/RESET lines through the selected GPIO backend
+    if (gpio_open(&dev->gpio, gpio_spec) < 0) {
+        goto SpiError;
+    }
+
+    // Set GPIO lines as outputs
+    if (gpio_request_output(&dev->gpio, SSD1306_DC_PIN, 0, "ssd1306") < 0 ||
+        gpio_request_output(&dev->gpio, SSD1306_RESET_PIN, 0, "ssd1306") < 0) {
+        gpio_close(&dev->gpio);
+        goto SpiError;
+    }
+    dev->dc_state = 0;
+
+    return 0;
+SpiError:
+    close(dev->spi_fd);
+    return -1;
+}
+
+void ssd1306_close(struct ssd1306 *dev) {
+    gpio_close(&dev->gpio);
+    close(dev->spi_fd);
+}
+
+int ssd1306_init(struct ssd1306 *dev) {
+    static const uint8_t init_seq[] = {
+        0xAE,       // Display off
+        0xD5, 0x80, // Set display clock divide ratio/oscillator frequency, default setting
+        0xA8, 0x3F, // Set multiplex ratio, 1/64 duty
+        0xD3, 0x00, // Set display offset, no offset
+        0x40,       // Set start line address
+        0x8D, 0x14, // Enable charge pump regulator
+        0x20, 0x00, // Set memory addressing mode, horizontal addressing mode
+        0xA1,       // Set segment re-map
+        0xC8,       // Set COM output scan direction
+        0xDA, 0x12, // Set COM pins hardware configuration, alternative COM pin configuration
+        0x81, 0xCF, // Set contrast control, maximum contrast
+        0xD9, 0xF1, // Set pre-charge period, phase 1: 15 DCLKs, phase 2: 1 DCLK
+        0xDB, 0x40, // Set VCOMH deselect level, VCOMH = 0.77*VCC
+        0xA4,       // Resume to RAM content display
+        0xA6,       // Normal display
+        0xAF,       // Display on
+    };
+
+    gpio_set(&dev->gpio, SSD1306_RESET_PIN, 0);
+    usleep(10000); // 10ms delay
+    gpio_set(&dev->gpio, SSD1306_RESET_PIN, 1);
+
+    if (ssd1306_commands(dev, init_seq, sizeof(init_seq)) < 0) {
+        return -1;
+    }
+
+    // The panel RAM is undefined after reset, push the whole framebuffer once
+    dev->dirty = 0xFF;
+    return ssd1306_flush(dev);
+}
+
+int ssd1306_flush(struct ssd1306 *dev) {
+    uint8_t page = 0;
+
+    while (dev->dirty) {
+        // Find the next run of consecutive dirty pages and send it as one window
+        while (!(dev->dirty & (1u << page))) {
+            page++;
+        }
+        uint8_t last = page;
+        while (last + 1 < SSD1306_PAGES && (dev->dirty & (1u << (last + 1)))) {
+            last++;
+        }
+
+        if (ssd1306_set_window(dev, 0, page, SSD1306_WIDTH, last - page + 1) < 0 ||
+            ssd1306_write(dev, 1, dev->fb[page], (size_t)(last - page + 1) * SSD1306_WIDTH) < 0) {
+            return -1;
+        }
+
+        for (uint8_t p = page; p <= last; p++) {
+            dev->dirty &= ~(1u << p);
+        }
+        page = last + 1;
+    }
+    return 0;
+}
+
+void ssd1306_fb_clear(struct ssd1306 *dev) {
+    memset(dev->fb, 0, sizeof(dev->fb));
+    dev->dirty = 0xFF;
+}
+
+void ssd1306_fb_clear_page(struct ssd1306 *dev, uint8_t page) {
+    if (page >= SSD1306_PAGES) {
+        return;
+    }
+    memset(dev->fb[page], 0, SSD1306_WIDTH);
+    dev->dirty |= 1u << page;
+}
+
+void ssd1306_fb_draw_char(struct ssd1306 *dev, uint8_t x, uint8_t page, char ch) {
+    if (ch < ' ' || ch > '~') {
+        ch = ' '; // Default to space if character out of range
+    }
+    if (page >= SSD1306_PAGES || x > SSD1306_WIDTH - SSD1306_FONT_WIDTH) {
+        return;
+    }
+    memcpy(&dev->fb[page][x], font5x8[ch - FONT5X8_FIRST], FONT5X8_WIDTH);
+    dev->fb[page][x + FONT5X8_WIDTH] = 0x00; // Add space after character
+    dev->dirty |= 1u << page;
+}
+
+void ssd1306_fb_draw_string(struct ssd1306 *dev, uint8_t x, uint8_t page, const char *str) {
+    while (*str) {
+        if (x > SSD1306_WIDTH - SSD1306_FONT_WIDTH) { // Wrap around
+            x = 0;
+            page++;
+            if (page >= SSD1306_PAGES) {
+                page = 0; // Start over from top
+            }
+        }
+        ssd1306_fb_draw_char(dev, x, page, *str++);
+        x += SSD1306_FONT_WIDTH; // Move cursor to the next character position
+    }
+}
+
+/*
+ * Draw a string with one of the generated atlases at a page aligned
+ * position, see font_draw_text().
+ */
+int ssd1306_fb_draw_text(struct ssd1306 *dev, const struct font_atlas *font,
+                         int x, int page, const char *str) {
+    const struct font_clip clip = { 0, SSD1306_WIDTH, 0, SSD1306_PAGES };
+    uint32_t dirty = 0;
+
+    int cursor = font_draw_text(&dev->fb[0][0], SSD1306_WIDTH, &clip, &dirty, font, x, page, str);
+    dev->dirty |= (uint8_t)dirty;
+    return cursor;
+}
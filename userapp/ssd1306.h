@@ -0,0 +1,65 @@
+/*
+ * ssd1306.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Minimal SSD1306 (128x64, SPI) driver shared by the userspace programs.
+ * Drawing goes into a page-major framebuffer in memory; only pages marked
+ * dirty are pushed to the panel by ssd1306_flush().
+ */
+
+#ifndef SSD1306_H
+#define SSD1306_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gpio_backend.h"
+#include "font5x8.h"
+#include "font_atlas.h"
+
+// Default SPI and GPIO settings (see ssd1306_spi.c for the wiring)
+#define SSD1306_SPI_PATH      "/dev/spidev0.0"
+#define SSD1306_SPI_SPEED     1000000
+#define SSD1306_SPI_SPEED_MAX 10000000    // 100 ns minimum SCLK cycle in the datasheet
+#define SSD1306_GPIO_CHIP     "gpiochip0" // any gpio_open() spec, e.g. "gpiomem"
+#define SSD1306_DC_PIN        25
+#define SSD1306_RESET_PIN     24
+
+#define SSD1306_WIDTH  128
+#define SSD1306_HEIGHT 64
+#define SSD1306_PAGES  (SSD1306_HEIGHT / 8)
+
+#define SSD1306_FONT_WIDTH 6 // 5 glyph columns + 1 spacing column
+
+struct ssd1306 {
+    int spi_fd;
+    struct gpio_dev gpio;                       // DC and RESET lines
+    int dc_state;                               // last value driven on DC, -1 if unknown
+    uint8_t fb[SSD1306_PAGES][SSD1306_WIDTH];   // one byte = 8 vertical pixels
+    uint8_t dirty;                              // bitmask of pages that need a flush
+};
+
+int  ssd1306_open(struct ssd1306 *dev, const char *spi_path, const char *gpio_spec);
+void ssd1306_close(struct ssd1306 *dev);
+int  ssd1306_init(struct ssd1306 *dev);
+
+int  ssd1306_commands(struct ssd1306 *dev, const uint8_t *cmds, size_t len);
+int  ssd1306_flush(struct ssd1306 *dev);
+
+/*
+ * Streaming access for high-rate updates: set an address window once, then
+ * every ssd1306_write_data() of exactly w * pages bytes rewrites the window
+ * and leaves the panel's address pointer back at its start. DC stays high
+ * between writes, so each update is a single SPI transfer.
+ */
+int  ssd1306_set_speed(struct ssd1306 *dev, uint32_t hz);
+int  ssd1306_set_window(struct ssd1306 *dev, uint8_t x, uint8_t page, uint8_t w, uint8_t pages);
+int  ssd1306_write_data(struct ssd1306 *dev, const uint8_t *buf, size_t len);
+
+void ssd1306_fb_clear(struct ssd1306 *dev);
+void ssd1306_fb_clear_page(struct ssd1306 *dev, uint8_t page);
+void ssd1306_fb_draw_char(struct ssd1306 *dev, uint8_t x, uint8_t page, char ch);
+void ssd1306_fb_draw_string(struct ssd1306 *dev, uint8_t x, uint8_t page, const char *str);
+int  ssd1306_fb_draw_text(struct ssd1306 *dev, const struct font_atlas *font,
+                          int x, int page, const char *str);
+
+#endif // SSD1306_H
@@ -0,0 +1,169 @@
+/*
+ * ssd1306_client.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "ssd1306_client.h"
+
+int ssd1306_client_open(struct ssd1306_client *c, const char *sock_path, struct ssd1306_rect region) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    char msg[64];
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = { .iov_base = msg, .iov_len = sizeof(msg) - 1 };
+    struct msghdr mh = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control.buf, .msg_controllen = sizeof(control.buf),
+    };
+    int fd = -1;
+
+    memset(c, 0, sizeof(*c));
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", sock_path);
+
+    c->sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (c->sock < 0 || connect(c->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("Failed to connect to ssd1306_server");
+        goto SockError;
+    }
+
+    // The connection stays open for the lifetime of the region
+    int len = snprintf(msg, sizeof(msg), "region %u %u %u %u\n", region.x, region.page, region.w, region.pages);
+    if (write(c->sock, msg, (size_t)len) != len) {
+        perror("Failed to request region");
+        goto SockError;
+    }
+    // The reply carries the slot memfd when the region was accepted
+    ssize_t n = recvmsg(c->sock, &mh, MSG_CMSG_CLOEXEC);
+    if (n <= 0) {
+        fprintf(stderr, "ssd1306_server closed the connection\n");
+        goto SockError;
+    }
+    msg[n] = '\0';
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+        memcpy(&fd, CMSG_DATA(cm), sizeof(fd));
+    }
+    if (strcmp(msg, "ok\n") || fd < 0) {
+        fprintf(stderr, "Region rejected: %s", msg);
+        if (fd >= 0) {
+            close(fd);
+        }
+        goto SockError;
+    }
+
+    c->slot = mmap(NULL, sizeof(struct ssd1306_slot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (c->slot == MAP_FAILED) {
+        perror("Failed to map display shared memory");
+        goto SockError;
+    }
+    if (c->slot->magic != SSD1306_SHM_MAGIC || c->slot->version != SSD1306_SHM_VERSION) {
+        fprintf(stderr, "Display shared memory version mismatch\n");
+        munmap(c->slot, sizeof(struct ssd1306_slot));
+        goto SockError;
+    }
+
+    c->region = region;
+    return 0;
+SockError:
+    if (c->sock >= 0) {
+        close(c->sock);
+    }
+    return -1;
+}
+
+void ssd1306_client_close(struct ssd1306_client *c) {
+    munmap(c->slot, sizeof(struct ssd1306_slot));
+    close(c->sock); // the server frees the slot and blanks the region
+}
+
+/*
+ * Queue a damage rectangle (clipped to the region). Rings the server only
+ * when it had already drained the ring; otherwise it is still draining and
+ * picks the new entry up on its own.
+ */
+int ssd1306_client_damage(struct ssd1306_client *c, struct ssd1306_rect rect) {
+    struct ssd1306_slot *slot = c->slot;
+    const struct ssd1306_rect *r = &c->region;
+    int x0 = rect.x > r->x ? rect.x : r->x;
+    int p0 = rect.page > r->page ? rect.page : r->page;
+    int x1 = rect.x + rect.w < r->x + r->w ? rect.x + rect.w : r->x + r->w;
+    int p1 = rect.page + rect.pages < r->page + r->pages ? rect.page + rect.pages : r->page + r->pages;
+
+    if (x0 >= x1 || p0 >= p1) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&slot->head, memory_order_relaxed);
+    int ring_bell;
+
+    if (head - atomic_load(&slot->tail) == SSD1306_SHM_RING) {
+        atomic_store(&slot->overflow, 1);
+        ring_bell = 1; // rare, do not bother being clever
+    } else {
+        slot->ring[head & (SSD1306_SHM_RING - 1)] = (struct ssd1306_rect){
+            (uint8_t)x0, (uint8_t)p0, (uint8_t)(x1 - x0), (uint8_t)(p1 - p0)
+        };
+        /*
+         * Publish, then look at tail (both seq_cst). The server stores tail
+         * and then re-reads head the same way, so either it sees this entry
+         * or we see that it had drained everything before it and ring.
+         */
+        atomic_store(&slot->head, head + 1);
+        ring_bell = atomic_load(&slot->tail) == head;
+    }
+
+    if (ring_bell) {
+        const char bell = 0;
+        if (send(c->sock, &bell, 1, MSG_DONTWAIT | MSG_NOSIGNAL) < 0 && errno != EAGAIN) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void ssd1306_client_clear(struct ssd1306_client *c) {
+    for (int p = c->region.page; p < c->region.page + c->region.pages; p++) {
+        memset(&c->slot->fb[p][c->region.x], 0, c->region.w);
+    }
+}
+
+// Draw text inside the region and submit the touched area as damage
+int ssd1306_client_draw_text(struct ssd1306_client *c, const struct font_atlas *font,
+                             int x, int page, const char *str) {
+    const struct ssd1306_rect *r = &c->region;
+    const struct font_clip clip = { r->x, r->x + r->w, r->page, r->page + r->pages };
+    uint32_t dirty = 0;
+
+    int cursor = font_draw_text(&c->slot->fb[0][0], SSD1306_WIDTH, &clip, &dirty, font, x, page, str);
+
+    if (!dirty) {
+        return cursor;
+    }
+
+    // Damage only the columns and pages the text touched
+    int x1 = font->rotation == FONT_ROT_90 ? x + font->width[0] : cursor;
+    int p0 = __builtin_ctz(dirty);
+    int p1 = 32 - __builtin_clz(dirty);
+    if (x < 0) {
+        x = 0;
+    }
+    if (x1 > SSD1306_WIDTH) {
+        x1 = SSD1306_WIDTH;
+    }
+    if (x < x1) {
+        ssd1306_client_damage(c, (struct ssd1306_rect){ (uint8_t)x, (uint8_t)p0, (uint8_t)(x1 - x), (uint8_t)(p1 - p0) });
+    }
+    return cursor;
+}
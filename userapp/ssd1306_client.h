@@ -0,0 +1,33 @@
+/*
+ * ssd1306_client.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Client side of ssd1306_server: request a screen region, draw into the
+ * shared framebuffer and submit damage rectangles.
+ */
+
+#ifndef SSD1306_CLIENT_H
+#define SSD1306_CLIENT_H
+
+#include "ssd1306_shm.h"
+
+struct ssd1306_client {
+    int sock;
+    struct ssd1306_slot *slot;  // memfd received from the server
+    struct ssd1306_rect region;
+};
+
+int  ssd1306_client_open(struct ssd1306_client *c, const char *sock_path, struct ssd1306_rect region);
+void ssd1306_client_close(struct ssd1306_client *c);
+
+// Framebuffer of this client in panel coordinates, only region is shown
+static inline uint8_t (*ssd1306_client_fb(struct ssd1306_client *c))[SSD1306_WIDTH] {
+    return c->slot->fb;
+}
+
+int  ssd1306_client_damage(struct ssd1306_client *c, struct ssd1306_rect rect);
+void ssd1306_client_clear(struct ssd1306_client *c);
+int  ssd1306_client_draw_text(struct ssd1306_client *c, const struct font_atlas *font,
+                              int x, int page, const char *str);
+
+#endif // SSD1306_CLIENT_H
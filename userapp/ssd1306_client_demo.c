@@ -0,0 +1,69 @@
+/*
+ * ssd1306_client_demo.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Example ssd1306_server client. Shows a text in its region, or with -c
+ * redraws a counter as fast as it can to load-test the server.
+ *
+ * usage: ssd1306_client_demo [-c frames] <x> <page> <width> <pages> [text]
+ *   e.g. ssd1306_client_demo 0 0 128 2 "status: ok"
+ *        ssd1306_client_demo -c 10000 64 4 64 4
+ *
+ * build: make ssd1306_client_demo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "ssd1306_client.h"
+
+int main(int argc, char *argv[]) {
+    struct ssd1306_client client;
+    struct ssd1306_rect region;
+    long frames = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:")) != -1) {
+        switch (opt) {
+        case 'c': frames = atol(optarg); break;
+        default: return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind < 4) {
+        fprintf(stderr, "Usage: %s [-c frames] <x> <page> <width> <pages> [text]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    region.x = (uint8_t)atoi(argv[optind]);
+    region.page = (uint8_t)atoi(argv[optind + 1]);
+    region.w = (uint8_t)atoi(argv[optind + 2]);
+    region.pages = (uint8_t)atoi(argv[optind + 3]);
+    const char *text = argc - optind > 4 ? argv[optind + 4] : "hello";
+
+    if (ssd1306_client_open(&client, SSD1306_SHM_SOCKET, region) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    // Use the large font when the region is tall enough
+    const struct font_atlas *font = region.pages >= 2 ? &font_10x16 : &font_5x8;
+
+    if (!frames) {
+        ssd1306_client_draw_text(&client, font, region.x, region.page, text);
+        pause(); // the region is released when the process exits
+    }
+
+    struct timespec start, end;
+    char counter[24];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < frames; i++) {
+        snprintf(counter, sizeof(counter), "%ld", i);
+        ssd1306_client_draw_text(&client, font, region.x, region.page, counter);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%ld updates in %.3f s (%.0f/s)\n", frames, secs, frames / secs);
+
+    ssd1306_client_close(&client);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,360 @@
+/*
+ * ssd1306_gray.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Description:
+ * Temporal dither grayscale on the 1-bpp SSD1306. A 2 to 4 bit image is
+ * turned into 2^bits - 1 precomputed bitplanes; a pixel of level g is lit
+ * in exactly g of them, with a 4x4 Bayer phase offset so neighbouring
+ * pixels blink out of step and the flicker averages out spatially too.
+ * The planes are then cycled at a fixed rate from a clock_nanosleep()
+ * paced loop.
+ *
+ * Only the bounding box of pixels with an intermediate level changes from
+ * plane to plane, so the address window is set to that box once and each
+ * plane afterwards is a single SPI data transfer with no command bytes and
+ * no DC toggling. SPI runs at SSD1306_SPI_SPEED_MAX by default.
+ *
+ * At the end the achieved plane rate, deadline overruns and the jitter of
+ * the plane interval, wakeup lateness and SPI write time are printed.
+ *
+ * build: make ssd1306_gray
+ * usage: ./ssd1306_gray [-b bits] [-r plane_hz] [-t seconds] [image.pgm]
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "rt_util.h"
+#include "ssd1306.h"
+
+#define GRAY_MIN_BITS   2
+#define GRAY_MAX_BITS   4
+#define GRAY_MAX_PLANES ((1 << GRAY_MAX_BITS) - 1)
+#define PLANE_BYTES     (SSD1306_PAGES * SSD1306_WIDTH)
+
+struct timing {
+    uint64_t count;
+    int64_t min, max;
+    double sum, sumsq;
+};
+
+static uint8_t level[SSD1306_HEIGHT][SSD1306_WIDTH];  // 0 .. planes
+static uint8_t planes[GRAY_MAX_PLANES][PLANE_BYTES];  // packed to the update window
+static volatile sig_atomic_t stop;
+
+static const uint8_t bayer4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+static void stop_handler(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static void timing_add(struct timing *t, int64_t ns) {
+    if (!t->count || ns < t->min) {
+        t->min = ns;
+    }
+    if (!t->count || ns > t->max) {
+        t->max = ns;
+    }
+    t->count++;
+    t->sum += (double)ns;
+    t->sumsq += (double)ns * (double)ns;
+}
+
+static void timing_report(const char *name, const struct timing *t) {
+    if (!t->count) {
+        return;
+    }
+    double avg = t->sum / (double)t->count;
+    double var = t->sumsq / (double)t->count - avg * avg;
+
+    printf("  %-10s min %8.1f  avg %8.1f  max %8.1f  stddev %7.1f us\n", name,
+           t->min / 1000.0, avg / 1000.0, t->max / 1000.0, sqrt(var > 0 ? var : 0) / 1000.0);
+}
+
+static int pgm_skip(FILE *f) {
+    int ch;
+
+    // Whitespace and '#' comments may appear between header fields
+    while ((ch = fgetc(f)) != EOF) {
+        if (ch == '#') {
+            while ((ch = fgetc(f)) != EOF && ch != '\n') {
+            }
+        } else if (ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n') {
+            return ungetc(ch, f) == EOF ? -1 : 0;
+        }
+    }
+    return -1;
+}
+
+// Load a binary PGM (P5) and scale it to the panel with nearest neighbour
+static int load_pgm(const char *path, int max_level) {
+    FILE *f = fopen(path, "rb");
+    unsigned int w, h, maxval;
+    int ret = -1;
+
+    if (!f) {
+        perror("Failed to open image");
+        return -1;
+    }
+    if (fgetc(f) != 'P' || fgetc(f) != '5' ||
+        pgm_skip(f) < 0 || fscanf(f, "%u", &w) != 1 ||
+        pgm_skip(f) < 0 || fscanf(f, "%u", &h) != 1 ||
+        pgm_skip(f) < 0 || fscanf(f, "%u", &maxval) != 1 ||
+        fgetc(f) == EOF || !w || !h || !maxval || maxval > 255) {
+        fprintf(stderr, "%s: not an 8-bit binary PGM (P5) image\n", path);
+        goto FileError;
+    }
+
+    uint8_t *pixels = malloc((size_t)w * h);
+    if (!pixels) {
+        perror("malloc");
+        goto FileError;
+    }
+    if (fread(pixels, 1, (size_t)w * h, f) != (size_t)w * h) {
+        fprintf(stderr, "%s: truncated image data\n", path);
+        goto PixelError;
+    }
+
+    for (int y = 0; y < SSD1306_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_WIDTH; x++) {
+            unsigned int v = pixels[(size_t)(y * h / SSD1306_HEIGHT) * w + x * w / SSD1306_WIDTH];
+            level[y][x] = (uint8_t)((v * (unsigned int)max_level + maxval / 2) / maxval);
+        }
+    }
+    ret = 0;
+PixelError:
+    free(pixels);
+FileError:
+    fclose(f);
+    return ret;
+}
+
+// Built-in test image: horizontal ramp on top, one band per level below
+static void test_pattern(int max_level) {
+    for (int y = 0; y < SSD1306_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_WIDTH; x++) {
+            if (y < SSD1306_HEIGHT / 2) {
+                level[y][x] = (uint8_t)(x * (max_level + 1) / SSD1306_WIDTH);
+            } else {
+                level[y][x] = (uint8_t)((SSD1306_WIDTH - 1 - x) * (max_level + 1) / SSD1306_WIDTH);
+            }
+        }
+    }
+}
+
+/*
+ * Build the bitplanes for the window x0..x1, page0..page1 (end exclusive),
+ * packed in the order the panel's horizontal addressing mode consumes them.
+ * Returns the full-panel image of plane 0 in fb for the initial flush.
+ */
+static void build_planes(int count, int x0, int x1, int page0, int page1,
+                         uint8_t fb[SSD1306_PAGES][SSD1306_WIDTH]) {
+    uint8_t frame[SSD1306_PAGES][SSD1306_WIDTH];
+
+    for (int s = 0; s < count; s++) {
+        memset(frame, 0, sizeof(frame));
+        for (int y = 0; y < SSD1306_HEIGHT; y++) {
+            for (int x = 0; x < SSD1306_WIDTH; x++) {
+                int phase = bayer4[y & 3][x & 3] * count / 16;
+                if ((s + phase) % count < level[y][x]) {
+                    frame[y / 8][x] |= (uint8_t)(1u << (y & 7));
+                }
+            }
+        }
+
+        uint8_t *out = planes[s];
+        for (int p = page0; p < page1; p++) {
+            memcpy(out, &frame[p][x0], (size_t)(x1 - x0));
+            out += x1 - x0;
+        }
+        if (s == 0) {
+            memcpy(fb, frame, sizeof(frame));
+        }
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-b bits] [-r plane_hz] [-t seconds] [-f spi_hz] [-g gpio_spec] [-p prio] [-n] [image.pgm]\n"
+                    "  -b  gray levels as 2^bits, %d to %d (default %d)\n"
+                    "  -r  bitplane rate in Hz, 0 runs as fast as SPI allows (default 0)\n"
+                    "  -t  run time in seconds (default 10)\n"
+                    "  -f  SPI clock in Hz (default %d)\n"
+                    "  -g  GPIO backend for the display DC/RESET lines (default %s)\n"
+                    "  -p  run with SCHED_FIFO at the given priority\n"
+                    "  -n  pace the loop without a panel, to measure timer jitter alone\n"
+                    "  image.pgm  8-bit binary PGM, scaled to 128x64 (default: test ramps)\n",
+            prog, GRAY_MIN_BITS, GRAY_MAX_BITS, GRAY_MIN_BITS, SSD1306_SPI_SPEED_MAX, SSD1306_GPIO_CHIP);
+}
+
+int main(int argc, char *argv[]) {
+    const char *gpio_spec = SSD1306_GPIO_CHIP;
+    uint32_t spi_hz = SSD1306_SPI_SPEED_MAX;
+    int bits = GRAY_MIN_BITS;
+    double rate = 0;
+    double seconds = 10;
+    int prio = 0;
+    int use_display = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:r:t:f:g:p:nh")) != -1) {
+        switch (opt) {
+        case 'b': bits = atoi(optarg); break;
+        case 'r': rate = atof(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        case 'f': spi_hz = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'g': gpio_spec = optarg; break;
+        case 'p': prio = atoi(optarg); break;
+        case 'n': use_display = 0; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (bits < GRAY_MIN_BITS || bits > GRAY_MAX_BITS || rate < 0 || seconds <= 0 || !spi_hz) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int count = (1 << bits) - 1; // bitplanes per gray frame, also the maximum level
+    if (optind < argc) {
+        if (load_pgm(argv[optind], count) < 0) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        test_pattern(count);
+    }
+
+    // Bounding box of the pixels that change between planes
+    int x0 = SSD1306_WIDTH, x1 = 0, page0 = SSD1306_PAGES, page1 = 0;
+    for (int y = 0; y < SSD1306_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_WIDTH; x++) {
+            if (level[y][x] > 0 && level[y][x] < count) {
+                x0 = x < x0 ? x : x0;
+                x1 = x + 1 > x1 ? x + 1 : x1;
+                page0 = y / 8 < page0 ? y / 8 : page0;
+                page1 = y / 8 + 1 > page1 ? y / 8 + 1 : page1;
+            }
+        }
+    }
+    if (x0 >= x1) {
+        fprintf(stderr, "Image has no intermediate levels, nothing to dither\n");
+        x0 = 0, x1 = 1, page0 = 0, page1 = 1;
+    }
+
+    struct ssd1306 oled;
+    size_t len = (size_t)(x1 - x0) * (size_t)(page1 - page0);
+    build_planes(count, x0, x1, page0, page1, oled.fb);
+
+    if (use_display) {
+        uint8_t fb[SSD1306_PAGES][SSD1306_WIDTH];
+
+        memcpy(fb, oled.fb, sizeof(fb)); // ssd1306_open() clears the struct
+        if (ssd1306_open(&oled, SSD1306_SPI_PATH, gpio_spec) < 0) {
+            return EXIT_FAILURE;
+        }
+        memcpy(oled.fb, fb, sizeof(fb));
+
+        /*
+         * Fastest internal oscillator and no clock division, so the panel
+         * scans as many times per bitplane as possible. SPI is raised only
+         * after init so the reset sequence runs at the safe default.
+         */
+        static const uint8_t fast_clock[] = { 0xD5, 0xF0 };
+        if (ssd1306_init(&oled) < 0 ||
+            ssd1306_commands(&oled, fast_clock, sizeof(fast_clock)) < 0 ||
+            ssd1306_set_speed(&oled, spi_hz) < 0 ||
+            ssd1306_set_window(&oled, (uint8_t)x0, (uint8_t)page0, (uint8_t)(x1 - x0), (uint8_t)(page1 - page0)) < 0) {
+            ssd1306_close(&oled);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%d levels, %d bitplanes, window %d,%d %dx%d pages, %zu bytes per plane\n",
+           count + 1, count, x0, page0, x1 - x0, page1 - page0, len);
+    if (use_display) {
+        printf("SPI %u Hz, at most %.0f planes/s on the wire\n", spi_hz, spi_hz / 8.0 / (double)len);
+    }
+
+    struct sigaction sa = { .sa_handler = stop_handler }; // no SA_RESTART, wake the sleep
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if (prio > 0) {
+        make_realtime(prio);
+    }
+
+    struct timing interval = { 0 }, lateness = { 0 }, write_time = { 0 };
+    int64_t period = rate > 0 ? (int64_t)(1e9 / rate) : 0;
+    int64_t start = now_ns();
+    int64_t end = start + (int64_t)(seconds * 1e9);
+    int64_t due = start;
+    int64_t prev = 0;
+    uint64_t n = 0, overruns = 0;
+    int ret = EXIT_SUCCESS;
+
+    while (!stop) {
+        if (period) {
+            due += period;
+            struct timespec ts = { due / 1000000000LL, due % 1000000000LL };
+            if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+                continue;
+            }
+        }
+
+        int64_t t0 = now_ns();
+        if (t0 >= end) {
+            break;
+        }
+        if (period) {
+            timing_add(&lateness, t0 - due);
+        }
+        if (n) {
+            timing_add(&interval, t0 - prev);
+        }
+        prev = t0;
+
+        if (use_display && ssd1306_write_data(&oled, planes[n % (uint64_t)count], len) < 0) {
+            ret = EXIT_FAILURE;
+            break;
+        }
+        n++;
+
+        int64_t t1 = now_ns();
+        timing_add(&write_time, t1 - t0);
+
+        // Missed the next deadline: drop to the current slot instead of bursting to catch up
+        if (period && t1 > due + period) {
+            overruns++;
+            due += (t1 - due) / period * period;
+        }
+    }
+
+    double elapsed = (now_ns() - start) / 1e9;
+    printf("\n%llu planes in %.3f s: %.1f planes/s, %.1f gray frames/s",
+           (unsigned long long)n, elapsed, n / elapsed, n / elapsed / count);
+    if (period) {
+        printf(", %llu overruns (target %.1f planes/s)", (unsigned long long)overruns, rate);
+    }
+    printf("\n");
+    timing_report("interval", &interval);
+    timing_report("lateness", &lateness);
+    timing_report(use_display ? "spi write" : "loop body", &write_time);
+
+    if (use_display) {
+        ssd1306_close(&oled);
+    }
+    return ret;
+}
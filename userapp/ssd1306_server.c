@@ -0,0 +1,413 @@
+/*
+ * ssd1306_server.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Description:
+ * Display server that owns /dev/spidev0.0 and the DC/RESET lines, so that
+ * several processes can draw to the one SSD1306 at the same time. Each
+ * client asks for a rectangular region over the control socket and gets
+ * its own shared memory slot back as a memfd (see ssd1306_shm.h). Clients
+ * draw into their slot's framebuffer and push damage rectangles into a
+ * lock-free ring; the server copies damaged rectangles into the panel
+ * framebuffer and flushes only the dirty pages, at most max_fps times per
+ * second.
+ *
+ * Like gpio_eventd.c everything runs in one epoll loop (evloop.c): the
+ * listening socket, client connections (region requests and doorbells), a
+ * flush timerfd and a signalfd.
+ *
+ * usage: ssd1306_server [-s socket_path] [-g gpio_spec] [-f max_fps] [-r rt_priority] [-n]
+ *        -n runs without a panel, for trying clients on a host
+ * client: see ssd1306_client.h and ssd1306_client_demo.c
+ *
+ * build: make ssd1306_server
+ */
+
+#define _GNU_SOURCE // accept4(), memfd_create()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include "evloop.h"
+#include "rt_util.h"
+#include "ssd1306_shm.h"
+
+#define CMD_BUF_SIZE 64
+#define DEFAULT_FPS  60
+
+struct client {
+    struct source src;
+    struct ssd1306_slot *slot;  // NULL until the region request was accepted
+    struct ssd1306_rect region; // authoritative copy, the one in the slot is client-writable
+    char buf[CMD_BUF_SIZE];
+    size_t len;
+};
+
+static struct source flush_src;
+static struct source signal_src;
+static struct source listen_src;
+static struct client clients[SSD1306_SHM_SLOTS];
+
+static struct ssd1306 oled;
+static int have_display;
+static int flush_armed;
+static int64_t flush_interval_ns;
+static int64_t last_flush_ns;
+static unsigned long flushes;
+
+// Flush as soon as the frame rate cap allows, coalescing everything until then
+static void schedule_flush(void) {
+    if (flush_armed || !oled.dirty) {
+        return;
+    }
+    int64_t delay = last_flush_ns + flush_interval_ns - now_ns();
+    if (delay < 1) {
+        delay = 1; // zero would disarm the timer
+    }
+    struct itimerspec its = { .it_value = { delay / 1000000000LL, delay % 1000000000LL } };
+    timerfd_settime(flush_src.fd, 0, &its, NULL);
+    flush_armed = 1;
+}
+
+static void composite(const struct ssd1306_slot *slot, struct ssd1306_rect rect) {
+    for (int p = rect.page; p < rect.page + rect.pages; p++) {
+        memcpy(&oled.fb[p][rect.x], &slot->fb[p][rect.x], rect.w);
+        oled.dirty |= 1u << p;
+    }
+}
+
+static void blank(struct ssd1306_rect rect) {
+    for (int p = rect.page; p < rect.page + rect.pages; p++) {
+        memset(&oled.fb[p][rect.x], 0, rect.w);
+        oled.dirty |= 1u << p;
+    }
+}
+
+// Consume every queued damage rectangle of one client's slot
+static void drain_slot(const struct client *c) {
+    struct ssd1306_slot *slot = c->slot;
+    uint32_t tail = atomic_load_explicit(&slot->tail, memory_order_relaxed);
+    uint32_t head = atomic_load(&slot->head);
+
+    while (tail != head) {
+        struct ssd1306_rect rect = slot->ring[tail & (SSD1306_SHM_RING - 1)];
+        // The ring is client-writable memory: never trust a rectangle outside the region
+        if (rect.w && rect.pages && ssd1306_rect_contains(&c->region, &rect)) {
+            composite(slot, rect);
+        }
+        tail++;
+        // Pairs with the publish-then-check in ssd1306_client_damage()
+        atomic_store(&slot->tail, tail);
+        head = atomic_load(&slot->head);
+    }
+
+    if (atomic_exchange(&slot->overflow, 0)) {
+        composite(slot, c->region);
+    }
+    schedule_flush();
+}
+
+static void flush_handler(struct source *src, uint32_t events) {
+    uint64_t expirations;
+    (void)events;
+
+    if (read(src->fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+        perror("timerfd read");
+    }
+
+    // Pick up anything that arrived without a doorbell while we were busy
+    for (int i = 0; i < SSD1306_SHM_SLOTS; i++) {
+        if (clients[i].src.fd >= 0 && clients[i].slot) {
+            struct ssd1306_slot *slot = clients[i].slot;
+            if (atomic_load(&slot->head) != atomic_load_explicit(&slot->tail, memory_order_relaxed)) {
+                drain_slot(&clients[i]);
+            }
+        }
+    }
+    flush_armed = 0; // kept set while draining so nothing re-arms the timer
+    if (!oled.dirty) {
+        return;
+    }
+
+    last_flush_ns = now_ns();
+    flushes++;
+    if (have_display) {
+        ssd1306_flush(&oled);
+    } else {
+        oled.dirty = 0;
+    }
+}
+
+static void signal_handler(struct source *src, uint32_t events) {
+    struct signalfd_siginfo info;
+    (void)events;
+
+    if (read(src->fd, &info, sizeof(info)) == sizeof(info)) {
+        printf("Received signal %u, shutting down\n", info.ssi_signo);
+    }
+    evloop_stop();
+}
+
+static void client_drop(struct client *c) {
+    if (c->slot) {
+        blank(c->region);
+        schedule_flush();
+        munmap(c->slot, sizeof(*c->slot));
+        c->slot = NULL;
+    }
+    remove_source(&c->src);
+}
+
+/*
+ * A fresh slot in its own memfd. The size is sealed so a client can not
+ * shrink it under the server's mapping and make the compositor fault.
+ */
+static struct ssd1306_slot *create_slot(struct ssd1306_rect region, int *fd_out) {
+    int fd = memfd_create("ssd1306_slot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        perror("memfd_create");
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(struct ssd1306_slot)) < 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        perror("Failed to size display shared memory");
+        close(fd);
+        return NULL;
+    }
+    struct ssd1306_slot *slot = mmap(NULL, sizeof(*slot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (slot == MAP_FAILED) {
+        perror("Failed to map display shared memory");
+        close(fd);
+        return NULL;
+    }
+    slot->magic = SSD1306_SHM_MAGIC;
+    slot->version = SSD1306_SHM_VERSION;
+    slot->region = region; // for the client's information only
+    *fd_out = fd;
+    return slot;
+}
+
+// "ok" reply with the slot memfd attached
+static int send_slot(int sock, int fd) {
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = { .iov_base = "ok\n", .iov_len = 3 };
+    struct msghdr mh = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control.buf, .msg_controllen = sizeof(control.buf),
+    };
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cm), &fd, sizeof(fd));
+    return sendmsg(sock, &mh, MSG_NOSIGNAL) == 3 ? 0 : -1;
+}
+
+static void handle_region_request(struct client *c, const char *line) {
+    unsigned int x, page, w, pages;
+    struct ssd1306_rect region;
+
+    if (sscanf(line, "region %u %u %u %u", &x, &page, &w, &pages) != 4 || !w || !pages ||
+        x + w > SSD1306_WIDTH || page + pages > SSD1306_PAGES) {
+        send(c->src.fd, "err invalid region\n", 19, MSG_NOSIGNAL);
+        client_drop(c);
+        return;
+    }
+    region = (struct ssd1306_rect){ (uint8_t)x, (uint8_t)page, (uint8_t)w, (uint8_t)pages };
+
+    for (int i = 0; i < SSD1306_SHM_SLOTS; i++) {
+        if (clients[i].src.fd >= 0 && clients[i].slot && ssd1306_rect_overlaps(&clients[i].region, &region)) {
+            send(c->src.fd, "err region overlaps\n", 20, MSG_NOSIGNAL);
+            client_drop(c);
+            return;
+        }
+    }
+
+    int fd;
+    struct ssd1306_slot *slot = create_slot(region, &fd);
+    if (!slot) {
+        send(c->src.fd, "err out of memory\n", 18, MSG_NOSIGNAL);
+        client_drop(c);
+        return;
+    }
+    c->slot = slot;
+    c->region = region;
+    int sent = send_slot(c->src.fd, fd);
+    close(fd); // the client holds its own reference now
+    if (sent < 0) {
+        client_drop(c);
+        return;
+    }
+    printf("client %d: region %u,%u %ux%u pages\n", (int)(c - clients), x, page, w, pages);
+}
+
+static void client_handler(struct source *src, uint32_t events) {
+    struct client *c = (struct client *)src;
+    char bells[64];
+    (void)events;
+
+    if (c->slot) {
+        // After the region request everything on the socket is a doorbell
+        ssize_t n = read(src->fd, bells, sizeof(bells));
+        if (n <= 0 && !(n < 0 && errno == EAGAIN)) {
+            client_drop(c);
+            return;
+        }
+        drain_slot(c);
+        return;
+    }
+
+    ssize_t n = read(src->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len);
+    if (n <= 0) {
+        if (!(n < 0 && errno == EAGAIN)) {
+            client_drop(c);
+        }
+        return;
+    }
+    c->len += (size_t)n;
+    c->buf[c->len] = '\0';
+
+    char *nl = strchr(c->buf, '\n');
+    if (nl) {
+        *nl = '\0';
+        handle_region_request(c, c->buf);
+    } else if (c->len == sizeof(c->buf) - 1) {
+        client_drop(c);
+    }
+}
+
+static void listen_handler(struct source *src, uint32_t events) {
+    int fd = accept4(src->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    (void)events;
+
+    if (fd < 0) {
+        perror("accept");
+        return;
+    }
+    for (int i = 0; i < SSD1306_SHM_SLOTS; i++) {
+        if (clients[i].src.fd < 0) {
+            clients[i].slot = NULL;
+            clients[i].len = 0;
+            if (add_source(&clients[i].src, fd, client_handler) < 0) {
+                close(fd);
+            }
+            return;
+        }
+    }
+    send(fd, "err no free slot\n", 17, MSG_NOSIGNAL);
+    close(fd);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-s socket_path] [-g gpio_spec] [-f max_fps] [-r rt_priority] [-n]\n"
+                    "  -s  control socket path (default %s)\n"
+                    "  -g  GPIO backend for the DC/RESET lines (default %s)\n"
+                    "  -f  maximum flush rate (default %d)\n"
+                    "  -r  run with SCHED_FIFO at the given priority\n"
+                    "  -n  run without the panel\n",
+            prog, SSD1306_SHM_SOCKET, SSD1306_GPIO_CHIP, DEFAULT_FPS);
+}
+
+int main(int argc, char *argv[]) {
+    const char *sock_path = SSD1306_SHM_SOCKET;
+    const char *gpio_spec = SSD1306_GPIO_CHIP;
+    int fps = DEFAULT_FPS;
+    int rt_prio = 0;
+    int use_display = 1;
+    int ret = EXIT_FAILURE;
+    int opt;
+    sigset_t mask;
+
+    while ((opt = getopt(argc, argv, "s:g:f:r:nh")) != -1) {
+        switch (opt) {
+        case 's': sock_path = optarg; break;
+        case 'g': gpio_spec = optarg; break;
+        case 'f': fps = atoi(optarg); break;
+        case 'r': rt_prio = atoi(optarg); break;
+        case 'n': use_display = 0; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (fps <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    flush_interval_ns = 1000000000LL / fps;
+
+    for (int i = 0; i < SSD1306_SHM_SLOTS; i++) {
+        clients[i].src.fd = -1;
+        clients[i].slot = NULL;
+    }
+
+    if (use_display) {
+        if (ssd1306_open(&oled, SSD1306_SPI_PATH, gpio_spec) < 0) {
+            return EXIT_FAILURE;
+        }
+        ssd1306_fb_clear(&oled);
+        if (ssd1306_init(&oled) < 0) {
+            ssd1306_close(&oled);
+            return EXIT_FAILURE;
+        }
+        have_display = 1;
+    }
+
+    if (evloop_init() < 0) {
+        goto DisplayError;
+    }
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+
+    int listen_fd = open_control_socket(sock_path, SSD1306_SHM_SLOTS);
+    if (listen_fd < 0 ||
+        add_source(&flush_src, timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), flush_handler) < 0 ||
+        add_source(&signal_src, signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC), signal_handler) < 0 ||
+        add_source(&listen_src, listen_fd, listen_handler) < 0) {
+        goto EpollError;
+    }
+
+    if (rt_prio > 0) {
+        make_realtime(rt_prio);
+    }
+
+    printf("ssd1306_server running, control socket %s, max %d fps%s\n",
+           sock_path, fps, have_display ? "" : ", no panel");
+
+    evloop_run();
+
+    printf("%lu flushes\n", flushes);
+    for (int i = 0; i < SSD1306_SHM_SLOTS; i++) {
+        if (clients[i].src.fd >= 0) {
+            client_drop(&clients[i]);
+        }
+    }
+    unlink(sock_path);
+    ret = EXIT_SUCCESS;
+EpollError:
+    evloop_close();
+DisplayError:
+    if (have_display) {
+        ssd1306_fb_clear(&oled);
+        ssd1306_flush(&oled);
+        ssd1306_close(&oled);
+    }
+    return ret;
+}
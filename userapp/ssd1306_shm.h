@@ -0,0 +1,63 @@
+/*
+ * ssd1306_shm.h
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Shared memory layout between ssd1306_server and its clients.
+ *
+ * The server owns the panel and gives every client a slot of its own: a
+ * memfd sized and sealed by the server and passed over the control socket
+ * with SCM_RIGHTS, so clients never see each other's memory. A client
+ * draws into the framebuffer of its slot (panel coordinates, only its
+ * region is used) and pushes damage rectangles into the slot's
+ * single-producer/single-consumer ring. The server composites damaged
+ * rectangles into the panel framebuffer and flushes dirty pages. Pixel
+ * data never crosses the control socket; the socket only carries the
+ * region request, the slot fd and a one byte doorbell when a ring goes
+ * from empty to non-empty.
+ */
+
+#ifndef SSD1306_SHM_H
+#define SSD1306_SHM_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+#define SSD1306_SHM_SOCKET  "/tmp/ssd1306_server.sock"
+#define SSD1306_SHM_MAGIC   0x53534431u // "SSD1"
+#define SSD1306_SHM_VERSION 2
+#define SSD1306_SHM_SLOTS   8           // clients served at the same time
+#define SSD1306_SHM_RING    64          // must be a power of two
+
+// Rectangles are in columns and 8-pixel pages, the panel's native granularity
+struct ssd1306_rect {
+    uint8_t x;
+    uint8_t page;
+    uint8_t w;
+    uint8_t pages;
+};
+
+struct ssd1306_slot {
+    uint32_t magic;
+    uint32_t version;
+    struct ssd1306_rect region;         // assigned by the server, informational only
+    // Producer (client) and consumer (server) indexes on separate cache lines
+    _Alignas(64) _Atomic uint32_t head;
+    _Alignas(64) _Atomic uint32_t tail;
+    _Alignas(64) _Atomic uint32_t overflow; // ring was full, redraw the whole region
+    struct ssd1306_rect ring[SSD1306_SHM_RING];
+    _Alignas(64) uint8_t fb[SSD1306_PAGES][SSD1306_WIDTH];
+};
+
+static inline int ssd1306_rect_contains(const struct ssd1306_rect *outer, const struct ssd1306_rect *inner) {
+    return inner->x >= outer->x && inner->page >= outer->page &&
+           inner->x + inner->w <= outer->x + outer->w &&
+           inner->page + inner->pages <= outer->page + outer->pages;
+}
+
+static inline int ssd1306_rect_overlaps(const struct ssd1306_rect *a, const struct ssd1306_rect *b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w &&
+           a->page < b->page + b->pages && b->page < a->page + a->pages;
+}
+
+#endif // SSD1306_SHM_H
@@ -0,0 +1,249 @@
+/*
+ * gen_font_atlas.c
+ * author: Venkata Naga Ravikiran Bulusu
+ *
+ * Build-time generator for font_atlas.c. Runs on the build host (not the
+ * target), takes the 5x8 base font and writes every atlas declared in
+ * font_atlas.h: scaled, rotated and proportional variants, all in SSD1306
+ * page-major layout so that rendering is a plain copy.
+ *
+ * usage: gen_font_atlas <output.c>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../font5x8.h"
+#include "../font_atlas.h"
+
+#define MAX_SCALE      3
+#define MAX_COLS       (8 * MAX_SCALE) // widest glyph: rotated or 3x scaled
+#define MAX_PAGES      MAX_SCALE
+#define SPACE_WIDTH    2               // proportional width of ' ' at 1x
+
+struct glyph {
+    uint8_t width;
+    uint8_t pages;
+    uint8_t col[MAX_PAGES][MAX_COLS];
+};
+
+struct atlas_spec {
+    const char *name;
+    unsigned int scale;
+    enum font_rotation rotation;
+    int proportional;
+};
+
+static const struct atlas_spec specs[] = {
+    { "font_5x8",        1, FONT_ROT_0,   0 },
+    { "font_10x16",      2, FONT_ROT_0,   0 },
+    { "font_15x24",      3, FONT_ROT_0,   0 },
+    { "font_5x8_rot90",  1, FONT_ROT_90,  0 },
+    { "font_5x8_rot180", 1, FONT_ROT_180, 0 },
+    { "font_5x8_prop",   1, FONT_ROT_0,   1 },
+    { "font_10x16_prop", 2, FONT_ROT_0,   1 },
+};
+
+static uint8_t reverse_bits(uint8_t b) {
+    uint8_t r = 0;
+    for (int i = 0; i < 8; i++) {
+        r |= ((b >> i) & 1) << (7 - i);
+    }
+    return r;
+}
+
+// Blow every pixel up to scale x scale and split the columns into pages
+static void scale_glyph(const uint8_t *src, unsigned int src_width, unsigned int scale, struct glyph *g) {
+    g->width = src_width * scale;
+    g->pages = scale;
+    for (unsigned int c = 0; c < src_width; c++) {
+        uint32_t tall = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (src[c] & (1u << bit)) {
+                tall |= ((1u << scale) - 1) << (bit * scale);
+            }
+        }
+        for (unsigned int s = 0; s < scale; s++) {
+            for (unsigned int p = 0; p < scale; p++) {
+                g->col[p][c * scale + s] = (tall >> (8 * p)) & 0xFF;
+            }
+        }
+    }
+}
+
+// Clockwise: glyph row r becomes column 7 - r, glyph column c becomes row c
+static void rotate90_glyph(const uint8_t *src, struct glyph *g) {
+    g->width = 8;
+    g->pages = 1;
+    for (int j = 0; j < 8; j++) {
+        uint8_t b = 0;
+        for (int c = 0; c < FONT5X8_WIDTH; c++) {
+            if (src[c] & (1u << (7 - j))) {
+                b |= 1u << c;
+            }
+        }
+        g->col[0][j] = b;
+    }
+}
+
+static void rotate180_glyph(const uint8_t *src, struct glyph *g) {
+    g->width = FONT5X8_WIDTH;
+    g->pages = 1;
+    for (int c = 0; c < FONT5X8_WIDTH; c++) {
+        g->col[0][c] = reverse_bits(src[FONT5X8_WIDTH - 1 - c]);
+    }
+}
+
+// Drop blank columns on both sides; blank glyphs keep a fixed width
+static void trim_glyph(const uint8_t *src, unsigned int *first, unsigned int *width) {
+    unsigned int lo = 0;
+    unsigned int hi = FONT5X8_WIDTH;
+
+    while (lo < hi && !src[lo]) {
+        lo++;
+    }
+    while (hi > lo && !src[hi - 1]) {
+        hi--;
+    }
+    if (lo == hi) {
+        *first = 0;
+        *width = SPACE_WIDTH;
+        return;
+    }
+    *first = lo;
+    *width = hi - lo;
+}
+
+/*
+ * A pair may be set one column tighter when the facing edge columns do not
+ * touch, not even diagonally, once the spacing column is removed (e.g. "LT").
+ */
+static int kern_pair(const uint8_t *left, const uint8_t *right) {
+    unsigned int lf, lw, rf, rw;
+
+    trim_glyph(left, &lf, &lw);
+    trim_glyph(right, &rf, &rw);
+    if (!left[lf] || !right[rf]) {
+        return 0; // never kern against blank glyphs
+    }
+
+    uint8_t edge = left[lf + lw - 1];
+    uint8_t grown = edge | (uint8_t)(edge << 1) | (edge >> 1);
+    return (grown & right[rf]) ? 0 : -1;
+}
+
+static void build_glyph(const struct atlas_spec *spec, const uint8_t *src, struct glyph *g) {
+    memset(g, 0, sizeof(*g));
+    switch (spec->rotation) {
+    case FONT_ROT_90:
+        rotate90_glyph(src, g);
+        break;
+    case FONT_ROT_180:
+        rotate180_glyph(src, g);
+        break;
+    default:
+        if (spec->proportional) {
+            unsigned int first, width;
+            uint8_t trimmed[FONT5X8_WIDTH] = { 0 };
+
+            trim_glyph(src, &first, &width);
+            memcpy(trimmed, src + first, src[first] ? width : 0);
+            scale_glyph(trimmed, width, spec->scale, g);
+        } else {
+            scale_glyph(src, FONT5X8_WIDTH, spec->scale, g);
+        }
+        break;
+    }
+}
+
+static void emit_atlas(FILE *out, const struct atlas_spec *spec) {
+    static struct glyph glyphs[FONT5X8_COUNT];
+    unsigned int offset = 0;
+
+    for (int i = 0; i < FONT5X8_COUNT; i++) {
+        build_glyph(spec, font5x8[i], &glyphs[i]);
+    }
+
+    fprintf(out, "static const uint8_t %s_width[%d] = {", spec->name, FONT5X8_COUNT);
+    for (int i = 0; i < FONT5X8_COUNT; i++) {
+        fprintf(out, "%s%u,", i % 16 ? " " : "\n    ", glyphs[i].width);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const uint16_t %s_offset[%d] = {", spec->name, FONT5X8_COUNT);
+    for (int i = 0; i < FONT5X8_COUNT; i++) {
+        fprintf(out, "%s%u,", i % 12 ? " " : "\n    ", offset);
+        offset += glyphs[i].width * glyphs[i].pages;
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const uint8_t %s_data[%u] = {\n", spec->name, offset);
+    for (int i = 0; i < FONT5X8_COUNT; i++) {
+        if (FONT5X8_FIRST + i == '\\') {
+            fprintf(out, "    // backslash\n"); // a trailing '\' would continue the comment
+        } else {
+            fprintf(out, "    // '%c'\n", FONT5X8_FIRST + i);
+        }
+        for (int p = 0; p < glyphs[i].pages; p++) {
+            fprintf(out, "   ");
+            for (int c = 0; c < glyphs[i].width; c++) {
+                fprintf(out, " 0x%02X,", glyphs[i].col[p][c]);
+            }
+            fprintf(out, "\n");
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    if (spec->proportional) {
+        fprintf(out, "static const int8_t %s_kerning[%d] = {", spec->name, FONT5X8_COUNT * FONT5X8_COUNT);
+        for (int l = 0; l < FONT5X8_COUNT; l++) {
+            fprintf(out, "\n   ");
+            for (int r = 0; r < FONT5X8_COUNT; r++) {
+                fprintf(out, " %d,", kern_pair(font5x8[l], font5x8[r]) * (int)spec->scale);
+            }
+        }
+        fprintf(out, "\n};\n\n");
+    }
+
+    fprintf(out, "const struct font_atlas %s = {\n", spec->name);
+    fprintf(out, "    .first        = %d,\n", FONT5X8_FIRST);
+    fprintf(out, "    .count        = %d,\n", FONT5X8_COUNT);
+    fprintf(out, "    .height_pages = %u,\n", glyphs[0].pages);
+    fprintf(out, "    .spacing      = %u,\n", spec->rotation == FONT_ROT_90 ? 0 : spec->scale);
+    fprintf(out, "    .rotation     = %d,\n", spec->rotation);
+    fprintf(out, "    .width        = %s_width,\n", spec->name);
+    fprintf(out, "    .offset       = %s_offset,\n", spec->name);
+    fprintf(out, "    .data         = %s_data,\n", spec->name);
+    if (spec->proportional) {
+        fprintf(out, "    .kerning      = %s_kerning,\n", spec->name);
+    } else {
+        fprintf(out, "    .kerning      = NULL,\n");
+    }
+    fprintf(out, "};\n\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <output.c>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        perror("Failed to open output file");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "/*\n * font_atlas.c\n * generated by tools/gen_font_atlas.c, do not edit\n */\n\n");
+    fprintf(out, "#include <stddef.h>\n#include \"font_atlas.h\"\n\n");
+    for (size_t i = 0; i < sizeof(specs) / sizeof(specs[0]); i++) {
+        emit_atlas(out, &specs[i]);
+    }
+
+    if (fclose(out) != 0) {
+        perror("Failed to write output file");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}